@@ -0,0 +1,18 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Checks/Source/AudioThreadHooks.h"
+
+//Each benchmark prints CSV (with a header row) to stdout, so results can be diffed and tracked over time
+
+//MultichannelBiquad against one juce::dsp::IIR::Filter per channel
+void runKernelBenchmark();
+
+//Cost of one coefficient update (LFO position to cutoff to coefficients) with the exact and the FastMath path,
+//(alone and as the stereo pair StereoSpread uses), and processBlock at the per-sample control rate, where coefficient
+//updates dominate
+void runCoefficientBenchmark();
+
+//FunkyFilterAudioProcessor::processBlock across block sizes, sample rates, channel counts, modulation modes and filter engines,
+//then each oversampling factor and filter, and the sidechain envelope follower, at one typical setting
+void runProcessBlockBenchmark();
@@ -0,0 +1,178 @@
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Render/Source/OfflinePlayHead.h"
+
+//==============================================================================
+//Exact (std::pow, std::tan) against FastMath coefficient updates: first the update alone, over a spread of LFO positions
+//so nothing is predictable, then processBlock at the per-sample control rate, where the updates are most of the work.
+//The stereo pair rows design both sides' coefficients for StereoSpread in one go, to compare with a single update.
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numPositions = 4096, numRepeats = 500;
+    constexpr int blockSize = 512, numChannels = 2, numBlocks = 2000;
+    constexpr int coefficientStride = 10; // Room for a stereo pair of biquad designs
+
+    // Spread over [0, 1) by the golden ratio, so consecutive positions are far apart
+    std::vector<float> makePositions()
+    {
+        std::vector<float> positions(numPositions);
+
+        for (int i = 0; i < numPositions; ++i)
+            positions[(size_t)i] = (float)std::fmod(i * 0.6180339887, 1.0);
+
+        return positions;
+    }
+
+    //Returns nanoseconds per coefficient update, over a 20 Hz to 20 kHz sweep
+    template <typename Update>
+    double measureUpdates(const std::vector<float>& positions, Update&& update)
+    {
+        const auto logMinimum = std::log10(20.0f), logRange = std::log10(20000.0f) - logMinimum;
+        std::vector<double> coefficients(positions.size() * coefficientStride);
+
+        const auto run = [&]()
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+                update(coefficients.data() + coefficientStride * i, positions[i], logMinimum, logRange);
+        };
+
+        // Warm up caches and branch predictors before timing
+        run();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int repeat = 0; repeat < numRepeats; ++repeat)
+            run();
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / ((double)numRepeats * (double)positions.size());
+    }
+
+    double measureUpdates(const std::vector<float>& positions, bool useStateVariableFilter, bool useFastMath)
+    {
+        return measureUpdates(positions, [useStateVariableFilter, useFastMath](double* c, float position, float logMinimum, float logRange)
+        {
+            const auto frequency = mapPositionToFrequency(position, logMinimum, logRange, useFastMath);
+
+            if (useStateVariableFilter)
+                makeStateVariableParameters(c, frequency, 2.0f, sampleRate, useFastMath);
+            else
+                makeBandPassFilter(c, frequency, 2.0f, sampleRate, useFastMath);
+        });
+    }
+
+    //The right side sits half the sweep away, like a 180 degree spread on a triangle
+    double measurePairUpdates(const std::vector<float>& positions, bool useStateVariableFilter, bool useFastMath)
+    {
+        return measureUpdates(positions, [useStateVariableFilter, useFastMath](double* c, float position, float logMinimum, float logRange)
+        {
+            const auto rightPosition = position < 0.5f ? position + 0.5f : position - 0.5f;
+            const auto leftFrequency = mapPositionToFrequency(position, logMinimum, logRange, useFastMath);
+            const auto rightFrequency = mapPositionToFrequency(rightPosition, logMinimum, logRange, useFastMath);
+
+            if (useStateVariableFilter)
+                makeStateVariableParameterPair(c, c + 2, leftFrequency, rightFrequency, 2.0f, sampleRate, useFastMath);
+            else
+                makeBandPassFilterPair(c, c + 5, leftFrequency, rightFrequency, 2.0f, sampleRate, useFastMath);
+        });
+    }
+
+    void setParameter(FunkyFilterAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.tree.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    //Returns nanoseconds per sample of processBlock with the cutoff recomputed every sample
+    double measureProcessBlock(int engine, bool useFastMath, float stereoSpread)
+    {
+        FunkyFilterAudioProcessor processor;
+        setParameter(processor, "ControlRate", 0);
+        setParameter(processor, "FilterEngine", engine == 1 ? 1.f : 0.f);
+        setParameter(processor, "BankVoices", engine == 2 ? 7.f : 0.f);
+        setParameter(processor, "FastMath", useFastMath ? 1.f : 0.f);
+        setParameter(processor, "StereoSpread", stereoSpread);
+
+        OfflinePlayHead playHead;
+        playHead.prepare(sampleRate);
+        processor.setPlayHead(&playHead);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        juce::Random random(1);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < blockSize; ++n)
+                noise.setSample(channel, n, random.nextFloat() * 2.f - 1.f);
+
+        juce::MidiBuffer midi;
+        double seconds = 0;
+
+        // Negative blocks are warm-up and aren't timed
+        for (int block = -numBlocks / 10; block < numBlocks; ++block)
+        {
+            buffer.makeCopyOf(noise, true);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            const auto ticks = juce::Time::getHighResolutionTicks() - start;
+
+            playHead.advance(blockSize);
+
+            if (block >= 0)
+                seconds += juce::Time::highResolutionTicksToSeconds(ticks);
+        }
+
+        processor.releaseResources();
+        processor.setPlayHead(nullptr);
+
+        return seconds * 1.0e9 / ((double)numBlocks * blockSize);
+    }
+}
+
+//==============================================================================
+void runCoefficientBenchmark()
+{
+    juce::ScopedNoDenormals noDenormals;
+    const auto positions = makePositions();
+
+    std::cout << "test,engine,exact_ns,fast_ns,speedup" << std::endl;
+
+    for (auto useStateVariableFilter : { false, true })
+    {
+        const auto exact = measureUpdates(positions, useStateVariableFilter, false);
+        const auto fast = measureUpdates(positions, useStateVariableFilter, true);
+
+        std::cout << "update," << (useStateVariableFilter ? "svf" : "biquad") << "," << exact << "," << fast << "," << exact / fast << std::endl;
+    }
+
+    for (auto useStateVariableFilter : { false, true })
+    {
+        const auto exact = measurePairUpdates(positions, useStateVariableFilter, false);
+        const auto fast = measurePairUpdates(positions, useStateVariableFilter, true);
+
+        std::cout << "update_stereo_pair," << (useStateVariableFilter ? "svf" : "biquad") << "," << exact << "," << fast << "," << exact / fast << std::endl;
+    }
+
+    // The single band with either engine, and the eight-voice bank (eight updates per sample)
+    const char* const engineNames[] = { "biquad", "svf", "bank8" };
+
+    for (int engine = 0; engine < (int)std::size(engineNames); ++engine)
+    {
+        const auto exact = measureProcessBlock(engine, false, 0.f);
+        const auto fast = measureProcessBlock(engine, true, 0.f);
+
+        std::cout << "process_block_per_sample," << engineNames[engine] << "," << exact << "," << fast << "," << exact / fast << std::endl;
+    }
+
+    // The single band again with a 90 degree stereo spread, a coefficient pair per sample
+    for (int engine = 0; engine < 2; ++engine)
+    {
+        const auto exact = measureProcessBlock(engine, false, 90.f);
+        const auto fast = measureProcessBlock(engine, true, 90.f);
+
+        std::cout << "process_block_per_sample," << engineNames[engine] << "_stereo_spread," << exact << "," << fast << "," << exact / fast << std::endl;
+    }
+}
@@ -0,0 +1,136 @@
+#include "Benchmarks.h"
+#include "../../Source/MultichannelBiquad.h"
+
+//==============================================================================
+//Micro-benchmark for the filter kernel: one juce::dsp::IIR::Filter per channel (the previous design) against
+//MultichannelBiquad, both ramping a shared band-pass coefficient set every controlInterval samples. The biquad is
+//timed at both precisions, since doubles fill half as many SIMD lanes.
+namespace
+{
+    constexpr int blockSize = 512, controlInterval = 32, numBlocks = 4000;
+    constexpr double sampleRate = 48000.0;
+
+    //Two coefficient sets to alternate between, so the ramps are never trivially flat
+    std::array<std::array<float, 5>, 2> makeTargets()
+    {
+        std::array<std::array<float, 5>, 2> targets;
+        const double frequencies[] = { 300.0, 3000.0 };
+
+        for (int i = 0; i < 2; ++i)
+        {
+            auto coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate, frequencies[i], 2.0f);
+            std::copy(coefficients->coefficients.begin(), coefficients->coefficients.end(), targets[i].begin());
+        }
+
+        return targets;
+    }
+
+    template <typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random(1);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int n = 0; n < buffer.getNumSamples(); ++n)
+                buffer.setSample(channel, n, (SampleType)(random.nextFloat() * 2.f - 1.f));
+    }
+
+    //Returns nanoseconds per sample per channel
+    template <typename SampleType, typename ProcessBlock>
+    double measure(int numChannels, ProcessBlock&& processBlock)
+    {
+        juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        fillWithNoise(buffer);
+
+        // Warm up caches and branch predictors before timing
+        for (int block = 0; block < numBlocks / 10; ++block)
+            processBlock(buffer, block);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+            processBlock(buffer, block);
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / ((double)numBlocks * blockSize * numChannels);
+    }
+
+    double measureScalarFilters(int numChannels, const std::array<std::array<float, 5>, 2>& targets)
+    {
+        auto coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate, 1000.0, 2.0f);
+        std::vector<juce::dsp::IIR::Filter<float>> filters((size_t)numChannels);
+
+        for (auto& filter : filters)
+        {
+            filter.coefficients = coefficients;
+            filter.reset();
+        }
+
+        auto* current = coefficients->getRawCoefficients();
+
+        return measure<float>(numChannels, [&](juce::AudioBuffer<float>& buffer, int block)
+        {
+            for (int start = 0; start < blockSize; start += controlInterval)
+            {
+                const auto& target = targets[(size_t)((block + start / controlInterval) % 2)];
+
+                float step[5];
+                for (int i = 0; i < 5; ++i)
+                    step[i] = (target[(size_t)i] - current[i]) / controlInterval;
+
+                for (int n = start; n < start + controlInterval; ++n)
+                {
+                    for (int i = 0; i < 5; ++i)
+                        current[i] += step[i];
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        auto* samples = buffer.getWritePointer(channel);
+                        samples[n] = filters[(size_t)channel].processSample(samples[n]);
+                    }
+                }
+            }
+        });
+    }
+
+    template <typename SampleType>
+    double measureMultichannelBiquad(int numChannels, const std::array<std::array<float, 5>, 2>& floatTargets)
+    {
+        std::array<std::array<SampleType, 5>, 2> targets;
+
+        for (size_t i = 0; i < targets.size(); ++i)
+            std::copy(floatTargets[i].begin(), floatTargets[i].end(), targets[i].begin());
+
+        MultichannelBiquad<SampleType> filter;
+        filter.prepare(numChannels, blockSize);
+        filter.reset();
+
+        return measure<SampleType>(numChannels, [&](juce::AudioBuffer<SampleType>& buffer, int block)
+        {
+            filter.load(buffer.getArrayOfReadPointers(), numChannels, blockSize);
+
+            for (int start = 0; start < blockSize; start += controlInterval)
+                filter.process(start, controlInterval, targets[(size_t)((block + start / controlInterval) % 2)].data());
+
+            filter.store(buffer.getArrayOfWritePointers(), numChannels, blockSize);
+        });
+    }
+}
+
+//==============================================================================
+void runKernelBenchmark()
+{
+    juce::ScopedNoDenormals noDenormals;
+    const auto targets = makeTargets();
+
+    std::cout << "channels,scalar_ns_per_sample,simd_ns_per_sample,speedup,simd_double_ns_per_sample" << std::endl;
+
+    for (auto numChannels : { 1, 2, 4, 6, 8, 12, 16 })
+    {
+        const auto scalar = measureScalarFilters(numChannels, targets);
+        const auto simd = measureMultichannelBiquad<float>(numChannels, targets);
+        const auto simdDouble = measureMultichannelBiquad<double>(numChannels, targets);
+
+        std::cout << numChannels << "," << scalar << "," << simd << "," << scalar / simd << "," << simdDouble << std::endl;
+    }
+}
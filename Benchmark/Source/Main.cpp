@@ -0,0 +1,24 @@
+#include "Benchmarks.h"
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // The processor's parameter tree expects a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::String suite = argc > 1 ? argv[1] : "process";
+
+    if (suite == "kernel")
+        runKernelBenchmark();
+    else if (suite == "process")
+        runProcessBlockBenchmark();
+    else if (suite == "coefficients")
+        runCoefficientBenchmark();
+    else
+    {
+        std::cerr << "Usage: FunkyFilterBenchmark [process|kernel|coefficients]" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Render/Source/OfflinePlayHead.h"
+
+//==============================================================================
+//Drives FunkyFilterAudioProcessor::processBlock the way a host would, with a transport that is always playing,
+//and times every block individually so the latency distribution is visible, not just the average.
+namespace
+{
+    struct Configuration
+    {
+        double sampleRate;
+        int blockSize, numChannels;
+        int engine; // Index into engineNames
+        bool useNoteDuration, useDoublePrecision;
+        int oversampling = 0; // Index into oversamplingNames
+        bool useEnvelope = false; // Half the LFO, half a stereo sidechain's envelope
+    };
+
+    struct Result
+    {
+        double nanosecondsPerSample, medianBlockMicroseconds, p99BlockMicroseconds, allocationsPerBlock;
+    };
+
+    // The single band with either engine, and a four-voice band-pass bank
+    const char* const engineNames[] = { "biquad", "svf", "bank4" };
+
+    // Each factor with either oversampling filter, in the order of the Oversampling choices
+    const char* const oversamplingNames[] = { "off", "iir_2x", "iir_4x", "iir_8x", "fir_2x", "fir_4x", "fir_8x" };
+
+    constexpr int numSidechainChannels = 2;
+    constexpr double secondsPerConfiguration = 1.0;
+    constexpr int minimumBlocks = 200;
+
+    void setParameter(FunkyFilterAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.tree.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    template <typename SampleType>
+    Result measure(const Configuration& configuration)
+    {
+        FunkyFilterAudioProcessor processor;
+
+        auto layout = processor.getBusesLayout();
+        layout.inputBuses.getReference(0) = juce::AudioChannelSet::canonicalChannelSet(configuration.numChannels);
+        layout.outputBuses.getReference(0) = juce::AudioChannelSet::canonicalChannelSet(configuration.numChannels);
+
+        if (configuration.useEnvelope)
+            layout.inputBuses.getReference(1) = juce::AudioChannelSet::canonicalChannelSet(numSidechainChannels);
+
+        processor.setBusesLayout(layout);
+
+        setParameter(processor, "UseNoteDuration", configuration.useNoteDuration ? 1.f : 0.f);
+        setParameter(processor, "FilterEngine", configuration.engine == 1 ? 1.f : 0.f);
+        setParameter(processor, "BankVoices", configuration.engine == 2 ? 3.f : 0.f);
+        setParameter(processor, "Oversampling", configuration.oversampling == 0 ? 0.f : (float)((configuration.oversampling - 1) % 3 + 1));
+        setParameter(processor, "OversamplingFilter", configuration.oversampling > 3 ? 1.f : 0.f);
+        setParameter(processor, "EnvelopeMix", configuration.useEnvelope ? 0.5f : 0.f);
+
+        OfflinePlayHead playHead;
+        playHead.prepare(configuration.sampleRate);
+        processor.setPlayHead(&playHead);
+        processor.setProcessingPrecision(std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                            : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails(configuration.sampleRate, configuration.blockSize);
+        processor.prepareToPlay(configuration.sampleRate, configuration.blockSize);
+
+        // Fresh noise is copied in before every block (outside the timed region) so the filter never settles into silence.
+        // The sidechain's channels, if any, follow the main ones.
+        const auto numBufferChannels = configuration.numChannels + (configuration.useEnvelope ? numSidechainChannels : 0);
+        juce::AudioBuffer<SampleType> noise(numBufferChannels, configuration.blockSize), buffer(numBufferChannels, configuration.blockSize);
+        juce::Random random(1);
+
+        for (int channel = 0; channel < noise.getNumChannels(); ++channel)
+            for (int n = 0; n < noise.getNumSamples(); ++n)
+                noise.setSample(channel, n, (SampleType)(random.nextFloat() * 2.f - 1.f));
+
+        juce::MidiBuffer midi;
+        const auto numBlocks = juce::jmax(minimumBlocks, (int)(secondsPerConfiguration * configuration.sampleRate / configuration.blockSize));
+        std::vector<double> blockSeconds((size_t)numBlocks);
+        juce::int64 allocations = 0;
+
+        for (int block = -minimumBlocks / 4; block < numBlocks; ++block)
+        {
+            buffer.makeCopyOf(noise, true);
+
+            const auto allocationsBefore = getThreadAllocationCount();
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            processor.processBlock(buffer, midi);
+
+            const auto ticks = juce::Time::getHighResolutionTicks() - start;
+            playHead.advance(configuration.blockSize);
+
+            // Negative blocks are warm-up and aren't recorded
+            if (block >= 0)
+            {
+                blockSeconds[(size_t)block] = juce::Time::highResolutionTicksToSeconds(ticks);
+                allocations += getThreadAllocationCount() - allocationsBefore;
+            }
+        }
+
+        processor.releaseResources();
+        processor.setPlayHead(nullptr);
+
+        const auto totalSeconds = std::accumulate(blockSeconds.begin(), blockSeconds.end(), 0.0);
+        std::sort(blockSeconds.begin(), blockSeconds.end());
+
+        Result result;
+        result.nanosecondsPerSample = totalSeconds * 1.0e9 / ((double)numBlocks * configuration.blockSize);
+        result.medianBlockMicroseconds = blockSeconds[blockSeconds.size() / 2] * 1.0e6;
+        result.p99BlockMicroseconds = blockSeconds[juce::jmin(blockSeconds.size() - 1, blockSeconds.size() * 99 / 100)] * 1.0e6;
+        result.allocationsPerBlock = (double)allocations / numBlocks;
+        return result;
+    }
+
+    Result measure(const Configuration& configuration)
+    {
+        return configuration.useDoublePrecision ? measure<double>(configuration) : measure<float>(configuration);
+    }
+
+    void print(const Configuration& configuration, const Result& result)
+    {
+        std::cout << configuration.sampleRate << "," << configuration.blockSize << "," << configuration.numChannels << ","
+                  << (configuration.useEnvelope ? "envelope" : configuration.useNoteDuration ? "note_duration" : "free") << ","
+                  << engineNames[configuration.engine] << ","
+                  << (configuration.useDoublePrecision ? "double" : "float") << ","
+                  << oversamplingNames[configuration.oversampling] << ","
+                  << result.nanosecondsPerSample << "," << result.medianBlockMicroseconds << ","
+                  << result.p99BlockMicroseconds << "," << result.allocationsPerBlock << std::endl;
+    }
+}
+
+//==============================================================================
+void runProcessBlockBenchmark()
+{
+    std::cout << "sample_rate,block_size,channels,modulation,engine,precision,oversampling,ns_per_sample,p50_block_us,p99_block_us,allocations_per_block" << std::endl;
+
+    for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+    {
+        for (int blockSize = 16; blockSize <= 4096; blockSize *= 2)
+        {
+            for (auto numChannels : { 1, 2, 6, 12, 16 })
+            {
+                for (auto useNoteDuration : { false, true })
+                {
+                    for (int engine = 0; engine < (int)std::size(engineNames); ++engine)
+                    {
+                        for (auto useDoublePrecision : { false, true })
+                        {
+                            const Configuration configuration{ sampleRate, blockSize, numChannels, engine, useNoteDuration, useDoublePrecision };
+                            print(configuration, measure(configuration));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Oversampling multiplies the filter's work, so it's measured at one typical host setting rather than across the matrix
+    for (int oversampling = 1; oversampling < (int)std::size(oversamplingNames); ++oversampling)
+    {
+        for (int engine = 0; engine < (int)std::size(engineNames); ++engine)
+        {
+            const Configuration configuration{ 44100.0, 512, 2, engine, false, false, oversampling };
+            print(configuration, measure(configuration));
+        }
+    }
+
+    // The envelope follower's detection should be lost in the noise next to the filter, so it's measured at the same
+    // setting against the free running rows above, at a block size where its per-block overhead would show
+    for (auto blockSize : { 64, 512 })
+    {
+        for (int engine = 0; engine < (int)std::size(engineNames); ++engine)
+        {
+            const Configuration configuration{ 44100.0, blockSize, 2, engine, false, false, 0, true };
+            print(configuration, measure(configuration));
+        }
+    }
+}
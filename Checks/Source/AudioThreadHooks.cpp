@@ -0,0 +1,191 @@
+#include "AudioThreadHooks.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+//==============================================================================
+//Allocation and lock counting. Only the calling thread's calls are counted, so background threads don't skew
+//the per-block figures. On glibc malloc, free, the aligned allocators and pthread_mutex_lock/trylock themselves are
+//wrapped, which also catches juce::HeapBlock, juce::CriticalSection, std::mutex and friends, and the aligned operator
+//new that over-aligned types such as juce::dsp::SIMDRegister go through; elsewhere the global operator new and delete
+//are replaced, aligned forms included, which catches everything allocated through C++ (and locks aren't counted).
+namespace
+{
+    thread_local juce::int64 threadAllocationCount = 0, threadDeallocationCount = 0, threadLockCount = 0;
+}
+
+juce::int64 getThreadAllocationCount() noexcept
+{
+    return threadAllocationCount;
+}
+
+juce::int64 getThreadDeallocationCount() noexcept
+{
+    return threadDeallocationCount;
+}
+
+juce::int64 getThreadLockCount() noexcept
+{
+    return threadLockCount;
+}
+
+#if defined(__GLIBC__)
+namespace
+{
+    using MutexLockFunction = int (*)(pthread_mutex_t*);
+    MutexLockFunction realMutexLock = nullptr, realMutexTryLock = nullptr;
+}
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        ++threadAllocationCount;
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        ++threadAllocationCount;
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size)
+    {
+        ++threadAllocationCount;
+        return __libc_realloc(pointer, size);
+    }
+
+    // aligned_alloc and posix_memalign are what C++17's aligned operator new calls
+    void* memalign(size_t alignment, size_t size)
+    {
+        ++threadAllocationCount;
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        ++threadAllocationCount;
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, size_t alignment, size_t size)
+    {
+        ++threadAllocationCount;
+
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        auto* allocated = __libc_memalign(alignment, size);
+
+        if (allocated == nullptr)
+            return ENOMEM;
+
+        *pointer = allocated;
+        return 0;
+    }
+
+    void free(void* pointer)
+    {
+        if (pointer != nullptr)
+            ++threadDeallocationCount;
+
+        __libc_free(pointer);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        ++threadLockCount;
+
+        // glibc doesn't export an internal alias to forward to, so the real one is looked up on first use
+        if (realMutexLock == nullptr)
+            realMutexLock = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+
+        return realMutexLock(mutex);
+    }
+
+    int pthread_mutex_trylock(pthread_mutex_t* mutex)
+    {
+        ++threadLockCount;
+
+        if (realMutexTryLock == nullptr)
+            realMutexTryLock = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_trylock"));
+
+        return realMutexTryLock(mutex);
+    }
+}
+#else
+void* operator new(std::size_t size)
+{
+    ++threadAllocationCount;
+
+    if (auto* pointer = std::malloc(size > 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        ++threadDeallocationCount;
+
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    if (pointer != nullptr)
+        ++threadDeallocationCount;
+
+    std::free(pointer);
+}
+
+//The aligned forms, which over-aligned types such as juce::dsp::SIMDRegister are allocated through
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    ++threadAllocationCount;
+    const auto bytes = size > 0 ? size : 1;
+
+   #if JUCE_WINDOWS
+    if (auto* pointer = _aligned_malloc(bytes, (std::size_t)alignment))
+        return pointer;
+   #else
+    void* pointer = nullptr;
+
+    if (::posix_memalign(&pointer, juce::jmax((std::size_t)alignment, sizeof(void*)), bytes) == 0)
+        return pointer;
+   #endif
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    if (pointer != nullptr)
+        ++threadDeallocationCount;
+
+   #if JUCE_WINDOWS
+    _aligned_free(pointer);
+   #else
+    std::free(pointer);
+   #endif
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(pointer, alignment);
+}
+#endif
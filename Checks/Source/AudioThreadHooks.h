@@ -0,0 +1,9 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Heap allocations, frees and mutex locks made by the calling thread so far, counted by the hooks in AudioThreadHooks.cpp.
+//Linked into the checks, and into the benchmarks for their per-block allocation figures.
+juce::int64 getThreadAllocationCount() noexcept;
+juce::int64 getThreadDeallocationCount() noexcept;
+juce::int64 getThreadLockCount() noexcept;
@@ -0,0 +1,20 @@
+#include "SafetyChecks.h"
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // The processor's parameter tree expects a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::StringArray arguments(argv + 1, argc - 1);
+
+    if (arguments.contains("--help"))
+    {
+        std::cout << "Usage: FunkyFilterChecks [--write-golden <file>]" << std::endl
+                  << std::endl
+                  << "  --write-golden <file>  Also write this build's golden fingerprints, to replace Golden/golden_fingerprints.csv" << std::endl;
+        return 0;
+    }
+
+    return runSafetyChecks(arguments);
+}
@@ -0,0 +1,794 @@
+#include "SafetyChecks.h"
+#include "AudioThreadHooks.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Render/Source/OfflinePlayHead.h"
+
+//==============================================================================
+//Regression checks that run headless, so changes to the DSP can be verified without a host:
+// - realtime safety: every processBlock call is watched for heap allocations, frees and mutex locks
+// - golden renders: a matrix of settings is rendered and compared, on every run, against fingerprints recorded from a
+//   known-good build (Golden/golden_fingerprints.csv); a case without a fingerprint fails
+// - fuzzing: random parameter automation (often to the ends of the ranges, so minimum above maximum, Q of 0.1 or 10),
+//   block sizes, input levels and transport states, with the output checked for NaNs and runaway levels. Denormals
+//   aren't looked for: processBlock runs under juce::ScopedNoDenormals, so none can reach the output or the state
+// - fast math: the FastMath coefficient path against the exact one, held to the error bounds documented in FastMath.h
+// - latency: with each oversampling stage, real time and offline, the output is delayed by exactly the reported latency
+// - sidechain: the envelope follower runs in golden renders (from the input and from a sidechain) and in half the fuzzing
+// - stereo pair: the two-lane designs used with StereoSpread against the single ones, lane by lane
+// - stereo layout: with StereoSpread on surround, ambisonic and discrete buses, only the right channels of left/right
+//   pairs may differ from the first channel
+namespace
+{
+    constexpr double goldenSampleRate = 48000.0;
+    constexpr int goldenBlockSize = 512, goldenChannels = 2, goldenLength = 96000;
+    constexpr int fingerprintSegments = 64;
+    constexpr float goldenTolerance = 1.0e-4f; // About -80 dB, loose enough for reordered arithmetic
+    constexpr double runawayLevel = 1000.0;
+    constexpr float latencyTolerance = 0.01f; // A sample off at 500 Hz would be over three times this
+    constexpr double stereoPairTolerance = 1.0e-12; // The same arithmetic per lane, so only contracted multiply-adds differ
+
+    struct Parameter
+    {
+        const char* parameterID;
+        float value;
+    };
+
+    struct GoldenCase
+    {
+        const char* name;
+        std::vector<Parameter> parameters;
+        bool useDoublePrecision = false;
+        bool useSidechain = false; // Feeds makeSidechainInput() to the sidechain bus
+    };
+
+    //The coefficient table stays off: it's built on a background thread, so the block it kicks in at isn't deterministic
+    std::vector<GoldenCase> getGoldenCases()
+    {
+        return {
+            { "biquad_default", {} },
+            { "biquad_per_sample", { { "ControlRate", 0 } } },
+            { "biquad_note_duration", { { "UseNoteDuration", 1 }, { "NoteDuration", 3 } } },
+            { "biquad_transport_sync", { { "UseNoteDuration", 1 }, { "TransportSync", 1 } } },
+            { "biquad_reversed_range", { { "MinimumFrequency", 8000 }, { "MaximumFrequency", 300 } } },
+            { "biquad_lowest_q", { { "FilterQuality", 0.1f } } },
+            { "biquad_highest_q", { { "FilterQuality", 10 } } },
+            { "biquad_double", {}, true },
+            { "svf_band_pass", { { "FilterEngine", 1 } } },
+            { "svf_low_pass", { { "FilterEngine", 1 }, { "FilterType", 1 } } },
+            { "svf_high_pass", { { "FilterEngine", 1 }, { "FilterType", 2 } } },
+            { "svf_notch", { { "FilterEngine", 1 }, { "FilterType", 3 } } },
+            { "shape_triangle", { { "LfoShape", 1 } } },
+            { "shape_saw", { { "LfoShape", 2 } } },
+            { "shape_square", { { "LfoShape", 3 } } },
+            { "shape_sample_and_hold", { { "LfoShape", 4 } } },
+            { "bank_4_voices", { { "BankVoices", 3 } } },
+            { "bank_8_voices", { { "BankVoices", 7 }, { "BankSpread", 3.5f }, { "BankPhaseOffset", 0.1f } } },
+            { "oversampled_4x_iir", { { "Oversampling", 2 } } },
+            { "oversampled_8x_fir", { { "Oversampling", 3 }, { "OversamplingFilter", 1 } } },
+            { "oversampled_2x_double", { { "Oversampling", 1 }, { "FilterEngine", 1 } }, true },
+            { "envelope_from_input", { { "EnvelopeMix", 1 } } },
+            { "envelope_rms_blend", { { "EnvelopeMix", 0.5f }, { "EnvelopeDetector", 1 }, { "EnvelopeAttack", 1 }, { "EnvelopeRelease", 50 } } },
+            { "envelope_sidechain", { { "EnvelopeMix", 1 } }, false, true },
+            { "envelope_sidechain_bank_double", { { "EnvelopeMix", 0.75f }, { "BankVoices", 3 }, { "Oversampling", 1 } }, true, true },
+            { "stereo_spread_90", { { "StereoSpread", 90 } } },
+            { "stereo_spread_svf_fast", { { "StereoSpread", 180 }, { "FilterEngine", 1 }, { "FastMath", 1 } } },
+            { "stereo_spread_oversampled_double", { { "StereoSpread", 45 }, { "LfoShape", 4 }, { "Oversampling", 1 } }, true },
+        };
+    }
+
+    struct OversamplingCase
+    {
+        const char* name;
+        std::vector<Parameter> parameters;
+        bool nonRealtime = false;
+    };
+
+    //The offline factor only applies while rendering offline, so the last case has to come out without any latency
+    std::vector<OversamplingCase> getOversamplingCases()
+    {
+        return {
+            { "off", {} },
+            { "iir_2x", { { "Oversampling", 1 } } },
+            { "iir_4x", { { "Oversampling", 2 } } },
+            { "iir_8x", { { "Oversampling", 3 } } },
+            { "fir_2x", { { "Oversampling", 1 }, { "OversamplingFilter", 1 } } },
+            { "fir_4x", { { "Oversampling", 2 }, { "OversamplingFilter", 1 } } },
+            { "fir_8x", { { "Oversampling", 3 }, { "OversamplingFilter", 1 } } },
+            { "offline_8x", { { "OfflineOversampling", 3 } }, true },
+            { "offline_8x_while_realtime", { { "OfflineOversampling", 3 } } },
+        };
+    }
+
+    //==============================================================================
+    struct AudioThreadActivity
+    {
+        juce::int64 allocations = 0, deallocations = 0, locks = 0;
+
+        bool isClean() const noexcept { return allocations == 0 && deallocations == 0 && locks == 0; }
+
+        juce::String describe() const
+        {
+            return juce::String(allocations) + " allocations " + juce::String(deallocations) + " frees " + juce::String(locks) + " locks";
+        }
+    };
+
+    struct OutputProblems
+    {
+        juce::int64 nonFinite = 0, runaway = 0;
+
+        bool any() const noexcept { return nonFinite > 0 || runaway > 0; }
+
+        juce::String describe() const
+        {
+            return juce::String(nonFinite) + " non-finite " + juce::String(runaway) + " runaway";
+        }
+    };
+
+    void setParameter(FunkyFilterAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.tree.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    //Only the processBlock call itself is watched, setting up the buffers around it may allocate
+    template <typename SampleType>
+    void processWatched(FunkyFilterAudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midi,
+                        AudioThreadActivity& activity)
+    {
+        const auto allocations = getThreadAllocationCount();
+        const auto deallocations = getThreadDeallocationCount();
+        const auto locks = getThreadLockCount();
+
+        processor.processBlock(buffer, midi);
+
+        activity.allocations += getThreadAllocationCount() - allocations;
+        activity.deallocations += getThreadDeallocationCount() - deallocations;
+        activity.locks += getThreadLockCount() - locks;
+    }
+
+    template <typename SampleType>
+    void scanOutput(const juce::AudioBuffer<SampleType>& buffer, OutputProblems& problems)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            const auto* samples = buffer.getReadPointer(channel);
+
+            for (int n = 0; n < buffer.getNumSamples(); ++n)
+            {
+                const auto magnitude = std::abs(samples[n]);
+
+                if (! std::isfinite(magnitude))
+                    ++problems.nonFinite;
+                else if (magnitude > runawayLevel)
+                    ++problems.runaway;
+            }
+        }
+    }
+
+    //Prepares the processor as a host would, with the editor's telemetry and spectrum paths running too.
+    //A connected sidechain is stereo, and its channels follow the main input's in the buffer.
+    template <typename SampleType>
+    void prepare(FunkyFilterAudioProcessor& processor, OfflinePlayHead& playHead, double sampleRate, int blockSize,
+                 const juce::AudioChannelSet& channelSet, bool useSidechain = false)
+    {
+        auto layout = processor.getBusesLayout();
+        layout.inputBuses.getReference(0) = channelSet;
+        layout.outputBuses.getReference(0) = channelSet;
+        layout.inputBuses.getReference(1) = useSidechain ? juce::AudioChannelSet::stereo() : juce::AudioChannelSet::disabled();
+        processor.setBusesLayout(layout);
+
+        playHead.prepare(sampleRate);
+        processor.setPlayHead(&playHead);
+        processor.setProcessingPrecision(std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                            : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        processor.getTelemetry().setEnabled(true);
+        processor.getSpectrumFifo().setEnabled(true);
+    }
+
+    //The same, on the canonical layout of that many channels
+    template <typename SampleType>
+    void prepare(FunkyFilterAudioProcessor& processor, OfflinePlayHead& playHead, double sampleRate, int blockSize, int numChannels,
+                 bool useSidechain = false)
+    {
+        prepare<SampleType>(processor, playHead, sampleRate, blockSize, juce::AudioChannelSet::canonicalChannelSet(numChannels), useSidechain);
+    }
+
+    void release(FunkyFilterAudioProcessor& processor)
+    {
+        processor.getTelemetry().setEnabled(false);
+        processor.getSpectrumFifo().setEnabled(false);
+        processor.releaseResources();
+        processor.setPlayHead(nullptr);
+    }
+
+    //==============================================================================
+    //Noise with a stretch of silence in the middle, which exercises the silence bypass and the restart after it
+    juce::AudioBuffer<float> makeGoldenInput()
+    {
+        juce::AudioBuffer<float> input(goldenChannels, goldenLength);
+        juce::Random random(1);
+
+        for (int channel = 0; channel < goldenChannels; ++channel)
+            for (int n = 0; n < goldenLength; ++n)
+                input.setSample(channel, n, 0.5f * (random.nextFloat() * 2.f - 1.f));
+
+        input.clear(goldenLength / 2, goldenLength / 4);
+        return input;
+    }
+
+    //Decaying bursts of noise four times a second, like a kick drum, so the envelope has something to follow.
+    //They carry on through the main input's silence, where the filter has nothing to do.
+    juce::AudioBuffer<float> makeSidechainInput()
+    {
+        constexpr int burstLength = (int)(goldenSampleRate / 4);
+        juce::AudioBuffer<float> input(2, goldenLength);
+        juce::Random random(2);
+
+        for (int n = 0; n < goldenLength; ++n)
+        {
+            const auto level = std::exp(-20.0 * (n % burstLength) / goldenSampleRate);
+
+            for (int channel = 0; channel < input.getNumChannels(); ++channel)
+                input.setSample(channel, n, (float)level * (random.nextFloat() * 2.f - 1.f));
+        }
+
+        return input;
+    }
+
+    template <typename SampleType>
+    juce::AudioBuffer<float> renderGoldenCase(const GoldenCase& goldenCase, const juce::AudioBuffer<float>& input,
+                                              const juce::AudioBuffer<float>& sidechain, AudioThreadActivity& activity)
+    {
+        FunkyFilterAudioProcessor processor;
+
+        for (const auto& parameter : goldenCase.parameters)
+            setParameter(processor, parameter.parameterID, parameter.value);
+
+        OfflinePlayHead playHead;
+        prepare<SampleType>(processor, playHead, goldenSampleRate, goldenBlockSize, goldenChannels, goldenCase.useSidechain);
+
+        const auto numBufferChannels = goldenChannels + (goldenCase.useSidechain ? sidechain.getNumChannels() : 0);
+        juce::AudioBuffer<SampleType> buffer(numBufferChannels, goldenBlockSize);
+        juce::AudioBuffer<float> output(goldenChannels, goldenLength);
+        juce::MidiBuffer midi;
+
+        for (int position = 0; position < goldenLength; position += goldenBlockSize)
+        {
+            const auto numSamples = juce::jmin(goldenBlockSize, goldenLength - position);
+            buffer.setSize(numBufferChannels, numSamples, false, false, true);
+
+            for (int channel = 0; channel < numBufferChannels; ++channel)
+                for (int n = 0; n < numSamples; ++n)
+                    buffer.setSample(channel, n, (SampleType)(channel < goldenChannels ? input.getSample(channel, position + n)
+                                                                                       : sidechain.getSample(channel - goldenChannels, position + n)));
+
+            processWatched(processor, buffer, midi, activity);
+
+            for (int channel = 0; channel < goldenChannels; ++channel)
+                for (int n = 0; n < numSamples; ++n)
+                    output.setSample(channel, position + n, (float)buffer.getSample(channel, n));
+
+            playHead.advance(numSamples);
+        }
+
+        release(processor);
+        return output;
+    }
+
+    //A golden render is kept as a fingerprint rather than in full: each channel is cut into fingerprintSegments
+    //stretches, and each stretch's RMS level and first sample are recorded. The levels catch a changed response
+    //anywhere in the render, the samples a changed phase or a shifted output, and the file stays small enough to commit.
+    std::vector<float> makeFingerprint(const juce::AudioBuffer<float>& buffer)
+    {
+        const auto segmentLength = buffer.getNumSamples() / fingerprintSegments;
+        std::vector<float> fingerprint;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            for (int segment = 0; segment < fingerprintSegments; ++segment)
+            {
+                const auto start = segment * segmentLength;
+                fingerprint.push_back(buffer.getRMSLevel(channel, start, segmentLength));
+                fingerprint.push_back(buffer.getSample(channel, start));
+            }
+        }
+
+        return fingerprint;
+    }
+
+    //One row per segment: case, channel, segment, RMS level, first sample. Nine decimal places are well inside goldenTolerance.
+    juce::String formatFingerprint(const juce::String& name, const std::vector<float>& fingerprint)
+    {
+        juce::String rows;
+
+        for (size_t i = 0; i + 1 < fingerprint.size(); i += 2)
+        {
+            const auto channel = (int)(i / 2) / fingerprintSegments, segment = (int)(i / 2) % fingerprintSegments;
+            rows << name << "," << channel << "," << segment << ","
+                 << juce::String(fingerprint[i], 9) << "," << juce::String(fingerprint[i + 1], 9) << "\n";
+        }
+
+        return rows;
+    }
+
+    //The fingerprints committed in Golden/golden_fingerprints.csv, which the checks project builds in as binary data
+    std::map<juce::String, std::vector<float>> loadGoldenFingerprints()
+    {
+        std::map<juce::String, std::vector<float>> fingerprints;
+        juce::StringArray lines;
+        lines.addLines(juce::String::fromUTF8(BinaryData::golden_fingerprints_csv, BinaryData::golden_fingerprints_csvSize));
+
+        // The header row and blank lines don't have five fields
+        for (const auto& line : lines)
+        {
+            const auto fields = juce::StringArray::fromTokens(line, ",", {});
+
+            if (fields.size() != 5 || fields[0] == "case")
+                continue;
+
+            auto& fingerprint = fingerprints[fields[0]];
+            fingerprint.push_back(fields[3].getFloatValue());
+            fingerprint.push_back(fields[4].getFloatValue());
+        }
+
+        return fingerprints;
+    }
+
+    //Returns the largest difference from the golden fingerprint, or a negative value if it's missing or doesn't match in size
+    float compareWithGoldenFingerprint(const std::map<juce::String, std::vector<float>>& goldenFingerprints,
+                                       const juce::String& name, const std::vector<float>& fingerprint)
+    {
+        const auto golden = goldenFingerprints.find(name);
+
+        if (golden == goldenFingerprints.end() || golden->second.size() != fingerprint.size())
+            return -1.f;
+
+        float difference = 0;
+
+        for (size_t i = 0; i < fingerprint.size(); ++i)
+            difference = juce::jmax(difference, std::abs(fingerprint[i] - golden->second[i]));
+
+        return difference;
+    }
+
+    //==============================================================================
+    //With the transport stopped the input passes through unfiltered, but still through the oversampler, so the output
+    //should be the input delayed by the reported latency. Returns the largest difference from that, for a sine well
+    //inside every stage's passband.
+    float measureLatencyError(const OversamplingCase& oversamplingCase, int& latency)
+    {
+        constexpr int blockSize = 512, numBlocks = 32, numChannels = 2;
+        constexpr double frequency = 500.0;
+
+        FunkyFilterAudioProcessor processor;
+
+        for (const auto& parameter : oversamplingCase.parameters)
+            setParameter(processor, parameter.parameterID, parameter.value);
+
+        processor.setNonRealtime(oversamplingCase.nonRealtime);
+
+        OfflinePlayHead playHead;
+        prepare<float>(processor, playHead, goldenSampleRate, blockSize, numChannels);
+        playHead.setPlaying(false);
+        latency = processor.getLatencySamples();
+
+        const auto getInput = [](int n)
+        {
+            return n < 0 ? 0.f : 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * frequency * n / goldenSampleRate);
+        };
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        float error = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto position = block * blockSize;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int n = 0; n < blockSize; ++n)
+                    buffer.setSample(channel, n, getInput(position + n));
+
+            processor.processBlock(buffer, midi);
+
+            // The first blocks are left out while the oversampling filters settle
+            if (block < numBlocks / 4)
+                continue;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int n = 0; n < blockSize; ++n)
+                    error = juce::jmax(error, std::abs(buffer.getSample(channel, n) - getInput(position + n - latency)));
+        }
+
+        release(processor);
+        return error;
+    }
+
+    //==============================================================================
+    //Drives one processor through random automation, block sizes, input levels and transport states.
+    //Half the seeds connect a sidechain, whose level changes independently of the input's.
+    template <typename SampleType>
+    void fuzz(int seed, double sampleRate, AudioThreadActivity& activity, OutputProblems& problems)
+    {
+        constexpr int maximumBlockSize = 1024, numBlocks = 4000, numChannels = 2;
+        const float inputLevels[] = { 0.f, 0.f, 1.0e-7f, 0.1f, 1.f, 4.f };
+
+        juce::Random random(seed);
+        FunkyFilterAudioProcessor processor;
+        OfflinePlayHead playHead(60.0 + 120.0 * random.nextDouble());
+
+        // Loop a few beats, so the transport sync has to handle wraps too
+        const auto loopStart = (double)random.nextInt(4);
+        playHead.setLoop(true, loopStart, loopStart + 0.25 + 4.0 * random.nextDouble());
+
+        const auto useSidechain = random.nextBool();
+        const auto numBufferChannels = numChannels + (useSidechain ? 2 : 0);
+        prepare<SampleType>(processor, playHead, sampleRate, maximumBlockSize, numChannels, useSidechain);
+
+        juce::AudioBuffer<SampleType> buffer(numBufferChannels, maximumBlockSize);
+        juce::MidiBuffer midi;
+        auto inputLevel = 0.5f, sidechainLevel = 0.5f;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Automate a few parameters per block, half the time to the very ends of their ranges
+            for (auto* parameter : processor.getParameters())
+            {
+                if (random.nextInt(8) != 0)
+                    continue;
+
+                const auto choice = random.nextInt(4);
+                parameter->setValueNotifyingHost(choice == 0 ? 0.f : choice == 1 ? 1.f : random.nextFloat());
+            }
+
+            if (random.nextInt(64) == 0)
+                playHead.setPlaying(random.nextInt(4) != 0);
+
+            if (random.nextInt(16) == 0)
+                inputLevel = inputLevels[random.nextInt((int)std::size(inputLevels))];
+
+            if (random.nextInt(16) == 0)
+                sidechainLevel = inputLevels[random.nextInt((int)std::size(inputLevels))];
+
+            const auto numSamples = 1 + random.nextInt(maximumBlockSize);
+            buffer.setSize(numBufferChannels, numSamples, false, false, true);
+
+            for (int channel = 0; channel < numBufferChannels; ++channel)
+                for (int n = 0; n < numSamples; ++n)
+                    buffer.setSample(channel, n, (SampleType)((channel < numChannels ? inputLevel : sidechainLevel) * (random.nextFloat() * 2.f - 1.f)));
+
+            processWatched(processor, buffer, midi, activity);
+
+            // Only the main channels are output, the sidechain's are left as they came in
+            scanOutput(juce::AudioBuffer<SampleType>(buffer.getArrayOfWritePointers(), numChannels, numSamples), problems);
+            playHead.advance(numSamples);
+        }
+
+        release(processor);
+    }
+
+    //==============================================================================
+    struct FastMathError
+    {
+        double cutoff = 0, gainDecibels = 0;
+    };
+
+    //Magnitude of (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2) at the given angular frequency
+    double getMagnitude(const double* c, double omega)
+    {
+        const auto z1 = std::polar(1.0, -omega), z2 = z1 * z1;
+        return std::abs((c[0] + c[1] * z1 + c[2] * z2) / (1.0 + c[3] * z1 + c[4] * z2));
+    }
+
+    //Sweeps the LFO across 20 Hz to 20 kHz and compares the whole fast chain (position to cutoff to coefficients) with
+    //the exact one: the cutoff each design ends up with, and the band-pass magnitude response across the same range
+    FastMathError measureFastMathError(double sampleRate, float filterQuality)
+    {
+        constexpr int numPositions = 1000, numFrequencies = 200;
+        const auto logMinimum = std::log10(20.0f), logRange = std::log10(20000.0f) - logMinimum;
+
+        // The band-pass is centred where cos(omega) = -a1 / (1 + a2), the SVF's cutoff is where tan(omega / 2) = g
+        const auto getCentre = [](const double* c) { return std::acos(-c[3] / (1.0 + c[4])); };
+        FastMathError error;
+
+        for (int i = 0; i <= numPositions; ++i)
+        {
+            const auto position = (float)i / numPositions;
+            const auto exactFrequency = mapPositionToFrequency(position, logMinimum, logRange, false);
+            const auto fastFrequency = mapPositionToFrequency(position, logMinimum, logRange, true);
+
+            double exact[5], fast[5], exactStateVariable[2], fastStateVariable[2];
+            makeBandPassFilter(exact, exactFrequency, filterQuality, sampleRate, false);
+            makeBandPassFilter(fast, fastFrequency, filterQuality, sampleRate, true);
+            makeStateVariableParameters(exactStateVariable, exactFrequency, filterQuality, sampleRate, false);
+            makeStateVariableParameters(fastStateVariable, fastFrequency, filterQuality, sampleRate, true);
+
+            error.cutoff = juce::jmax(error.cutoff,
+                                      std::abs(getCentre(fast) / getCentre(exact) - 1.0),
+                                      std::abs(std::atan(fastStateVariable[0]) / std::atan(exactStateVariable[0]) - 1.0));
+
+            for (int k = 0; k < numFrequencies; ++k)
+            {
+                const auto frequency = juce::jmin(20.0 * std::pow(1000.0, (double)k / (numFrequencies - 1)), 0.5 * sampleRate);
+                const auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+                const auto difference = juce::Decibels::gainToDecibels(getMagnitude(fast, omega) / getMagnitude(exact, omega), -400.0);
+
+                error.gainDecibels = juce::jmax(error.gainDecibels, std::abs(difference));
+            }
+        }
+
+        return error;
+    }
+
+    //Sweeps both sides across 20 Hz to 20 kHz, a different cutoff on each, and returns the largest difference between
+    //a pair design's lanes and the single design of the same cutoff, over the band-pass coefficients and the SVF's (g, k)
+    double measureStereoPairError(double sampleRate, float filterQuality, bool useFastMath)
+    {
+        constexpr int numPositions = 1000;
+        const auto logMinimum = std::log10(20.0f), logRange = std::log10(20000.0f) - logMinimum;
+        double error = 0;
+
+        for (int i = 0; i <= numPositions; ++i)
+        {
+            const auto leftPosition = (float)i / numPositions;
+            const auto rightPosition = 1.f - leftPosition;
+            const auto leftFrequency = mapPositionToFrequency(leftPosition, logMinimum, logRange, useFastMath);
+            const auto rightFrequency = mapPositionToFrequency(rightPosition, logMinimum, logRange, useFastMath);
+
+            double pair[2][5], single[2][5], pairStateVariable[2][2], singleStateVariable[2][2];
+            makeBandPassFilterPair(pair[0], pair[1], leftFrequency, rightFrequency, filterQuality, sampleRate, useFastMath);
+            makeBandPassFilter(single[0], leftFrequency, filterQuality, sampleRate, useFastMath);
+            makeBandPassFilter(single[1], rightFrequency, filterQuality, sampleRate, useFastMath);
+            makeStateVariableParameterPair(pairStateVariable[0], pairStateVariable[1], leftFrequency, rightFrequency,
+                                           filterQuality, sampleRate, useFastMath);
+            makeStateVariableParameters(singleStateVariable[0], leftFrequency, filterQuality, sampleRate, useFastMath);
+            makeStateVariableParameters(singleStateVariable[1], rightFrequency, filterQuality, sampleRate, useFastMath);
+
+            for (int side = 0; side < 2; ++side)
+            {
+                for (int k = 0; k < 5; ++k)
+                    error = juce::jmax(error, std::abs(pair[side][k] - single[side][k]));
+
+                for (int k = 0; k < 2; ++k)
+                    error = juce::jmax(error, std::abs(pairStateVariable[side][k] - singleStateVariable[side][k]));
+            }
+        }
+
+        return error;
+    }
+
+    //==============================================================================
+    struct LayoutCase
+    {
+        const char* name;
+        juce::AudioChannelSet channelSet;
+        std::vector<juce::AudioChannelSet::ChannelType> rightChannels; // The ones StereoSpread should move
+    };
+
+    std::vector<LayoutCase> getLayoutCases()
+    {
+        using Set = juce::AudioChannelSet;
+
+        return {
+            { "mono", Set::mono(), {} },
+            { "stereo", Set::stereo(), { Set::right } },
+            { "lcr", Set::createLCR(), { Set::right } },
+            { "5.1", Set::create5point1(), { Set::right, Set::rightSurround } },
+            { "7.1", Set::create7point1(), { Set::right, Set::rightSurround, Set::rightSurroundRear } },
+            { "ambisonic_1", Set::ambisonic(1), {} },
+            { "ambisonic_3", Set::ambisonic(3), {} },
+            { "discrete_6", Set::discreteChannels(6), {} }
+        };
+    }
+
+    //Feeds the same noise to every channel with StereoSpread, and returns what's wrong with the outputs, if anything:
+    //the right channels should all match each other and differ from the first channel, every other channel match it
+    juce::String checkLayoutSpread(const LayoutCase& layoutCase, bool useStateVariableFilter)
+    {
+        constexpr int blockSize = 512, numBlocks = 16;
+        const auto numChannels = layoutCase.channelSet.size();
+
+        FunkyFilterAudioProcessor processor;
+        setParameter(processor, "StereoSpread", 90.f);
+        setParameter(processor, "FilterEngine", useStateVariableFilter ? 1.f : 0.f);
+
+        OfflinePlayHead playHead;
+        prepare<float>(processor, playHead, goldenSampleRate, blockSize, layoutCase.channelSet);
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(3);
+        float leftDifference = 0, rightDifference = 0, spread = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int n = 0; n < blockSize; ++n)
+            {
+                const auto sample = 0.5f * (random.nextFloat() * 2.f - 1.f);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.setSample(channel, n, sample);
+            }
+
+            processor.processBlock(buffer, midi);
+
+            // Every right channel is compared with the first one found, every other channel with channel 0
+            int firstRight = -1;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto& rights = layoutCase.rightChannels;
+                const auto isRight = std::find(rights.begin(), rights.end(), layoutCase.channelSet.getTypeOfChannel(channel)) != rights.end();
+
+                if (isRight && firstRight < 0)
+                    firstRight = channel;
+
+                const auto reference = isRight ? firstRight : 0;
+
+                for (int n = 0; n < blockSize; ++n)
+                {
+                    const auto difference = std::abs(buffer.getSample(channel, n) - buffer.getSample(reference, n));
+                    auto& largest = isRight ? rightDifference : leftDifference;
+                    largest = juce::jmax(largest, difference);
+
+                    if (isRight)
+                        spread = juce::jmax(spread, std::abs(buffer.getSample(channel, n) - buffer.getSample(0, n)));
+                }
+            }
+
+            playHead.advance(blockSize);
+        }
+
+        release(processor);
+
+        juce::String problems;
+
+        if (leftDifference > 0)
+            problems << "shared channels differ by " << leftDifference << " ";
+
+        if (rightDifference > 0)
+            problems << "right channels differ by " << rightDifference << " ";
+
+        if (!layoutCase.rightChannels.empty() && spread == 0)
+            problems << "right channels aren't spread";
+
+        return problems.trim();
+    }
+}
+
+//==============================================================================
+int runSafetyChecks(const juce::StringArray& arguments)
+{
+    juce::File newGoldenFile;
+
+    for (int i = 0; i + 1 < arguments.size(); i += 2)
+        if (arguments[i] == "--write-golden")
+            newGoldenFile = juce::File::getCurrentWorkingDirectory().getChildFile(arguments[i + 1]);
+
+    int failures = 0;
+
+    const auto report = [&failures](const juce::String& check, const juce::String& name, bool passed, const juce::String& detail)
+    {
+        failures += passed ? 0 : 1;
+        std::cout << check << "," << name << "," << (passed ? "pass" : "FAIL") << "," << detail << std::endl;
+    };
+
+    std::cout << "check,case,result,detail" << std::endl;
+
+    // Golden renders, which are also watched for realtime safety and bad output
+    const auto input = makeGoldenInput();
+    const auto sidechain = makeSidechainInput();
+    const auto goldenFingerprints = loadGoldenFingerprints();
+    juce::String newGoldenFingerprints = "case,channel,segment,rms,sample\n";
+
+    for (const auto& goldenCase : getGoldenCases())
+    {
+        AudioThreadActivity activity;
+        OutputProblems problems;
+
+        const auto output = goldenCase.useDoublePrecision ? renderGoldenCase<double>(goldenCase, input, sidechain, activity)
+                                                          : renderGoldenCase<float>(goldenCase, input, sidechain, activity);
+        scanOutput(output, problems);
+
+        report("realtime", goldenCase.name, activity.isClean(), activity.describe());
+        report("output", goldenCase.name, ! problems.any(), problems.describe());
+
+        const auto fingerprint = makeFingerprint(output);
+        const auto difference = compareWithGoldenFingerprint(goldenFingerprints, goldenCase.name, fingerprint);
+        newGoldenFingerprints << formatFingerprint(goldenCase.name, fingerprint);
+
+        // An unrecorded case fails like a changed one, but says how to record it
+        juce::String detail;
+
+        if (goldenFingerprints.count(goldenCase.name) == 0)
+            detail = "no golden fingerprint recorded, run --write-golden on a known-good build";
+        else if (difference < 0)
+            detail = "golden fingerprint has a different length";
+        else
+            detail = "max difference " + juce::String(juce::Decibels::gainToDecibels(difference, -200.f), 1) + " dB";
+
+        report("golden", goldenCase.name, difference >= 0 && difference <= goldenTolerance, detail);
+    }
+
+    // Recorded after the comparisons, so a new build's fingerprints are only committed once its failures are understood
+    if (newGoldenFile != juce::File())
+        report("write_golden", newGoldenFile.getFileName(), newGoldenFile.replaceWithText(newGoldenFingerprints), newGoldenFile.getFullPathName());
+
+    // Fuzzing at sample rates both sides of twice the highest cutoff parameter, in both precisions
+    int seed = 1;
+
+    for (auto sampleRate : { 22050.0, 44100.0, 96000.0 })
+    {
+        for (auto useDoublePrecision : { false, true })
+        {
+            AudioThreadActivity activity;
+            OutputProblems problems;
+
+            if (useDoublePrecision)
+                fuzz<double>(seed, sampleRate, activity, problems);
+            else
+                fuzz<float>(seed, sampleRate, activity, problems);
+
+            const auto name = "seed_" + juce::String(seed) + "_" + juce::String((int)sampleRate) + (useDoublePrecision ? "_double" : "_float");
+            report("fuzz_realtime", name, activity.isClean(), activity.describe());
+            report("fuzz_output", name, ! problems.any(), problems.describe());
+            ++seed;
+        }
+    }
+
+    // Oversampling latency, as reported to the host against the delay the output actually has
+    for (const auto& oversamplingCase : getOversamplingCases())
+    {
+        int latency = 0;
+        const auto error = measureLatencyError(oversamplingCase, latency);
+
+        report("latency", oversamplingCase.name, error <= latencyTolerance,
+               juce::String(latency) + " samples, max difference " + juce::String(juce::Decibels::gainToDecibels(error, -200.f), 1) + " dB");
+    }
+
+    // Fast math error bounds, at the common sample rates and across the Q range
+    for (auto sampleRate : { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 })
+    {
+        FastMathError error;
+
+        for (auto filterQuality : { 0.1f, 0.707f, 1.f, 4.f, 10.f })
+        {
+            const auto qualityError = measureFastMathError(sampleRate, filterQuality);
+            error.cutoff = juce::jmax(error.cutoff, qualityError.cutoff);
+            error.gainDecibels = juce::jmax(error.gainDecibels, qualityError.gainDecibels);
+        }
+
+        const auto name = juce::String((int)sampleRate);
+        report("fast_math_cutoff", name, error.cutoff <= FastMath::maximumCutoffError, "max relative error " + juce::String(error.cutoff));
+        report("fast_math_gain", name, error.gainDecibels <= FastMath::maximumGainErrorDecibels,
+               "max error " + juce::String(error.gainDecibels) + " dB");
+    }
+
+    // The two-lane designs StereoSpread uses, exact and fast, have to agree with the single ones
+    for (auto useFastMath : { false, true })
+    {
+        double error = 0;
+
+        for (auto sampleRate : { 44100.0, 96000.0, 192000.0 })
+            for (auto filterQuality : { 0.1f, 1.f, 10.f })
+                error = juce::jmax(error, measureStereoPairError(sampleRate, filterQuality, useFastMath));
+
+        report("stereo_pair", useFastMath ? "fast" : "exact", error <= stereoPairTolerance, "max difference " + juce::String(error));
+    }
+
+    // StereoSpread follows the bus's channel types, not the channel order
+    for (const auto& layoutCase : getLayoutCases())
+    {
+        for (auto useStateVariableFilter : { false, true })
+        {
+            const auto problems = checkLayoutSpread(layoutCase, useStateVariableFilter);
+            const auto name = juce::String(layoutCase.name) + (useStateVariableFilter ? "_svf" : "_biquad");
+            report("stereo_layout", name, problems.isEmpty(), problems.isEmpty() ? juce::String("as expected") : problems);
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
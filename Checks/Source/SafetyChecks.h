@@ -0,0 +1,9 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Headless regression checks for DSP changes: realtime safety of processBlock, golden renders, parameter fuzzing,
+//the FastMath error bounds, the latency reported with oversampling, the sidechain envelope follower, the stereo pair
+//designs and how StereoSpread applies to each bus layout.
+//Prints one CSV row per check and returns the process exit code (non-zero if anything failed).
+int runSafetyChecks(const juce::StringArray& arguments);
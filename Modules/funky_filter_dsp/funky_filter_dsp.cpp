@@ -0,0 +1,11 @@
+#include "funky_filter_dsp.h"
+
+//The sources are built here as one unit, so none of them may define a file-local name another one uses
+#include "../../Source/BiquadBank.cpp"
+#include "../../Source/CoefficientTable.cpp"
+#include "../../Source/EnvelopeFollower.cpp"
+#include "../../Source/MultichannelBiquad.cpp"
+#include "../../Source/MultichannelSVF.cpp"
+#include "../../Source/PresetBank.cpp"
+#include "../../Source/ProcessLoadMonitor.cpp"
+#include "../../Source/SpectrumAnalyser.cpp"
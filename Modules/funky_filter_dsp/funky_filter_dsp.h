@@ -0,0 +1,23 @@
+/*******************************************************************************
+ BEGIN_JUCE_MODULE_DECLARATION
+
+  ID:                 funky_filter_dsp
+  vendor:             FunkyFilter
+  version:            1.0.0
+  name:               FunkyFilter DSP
+  description:        Filter engines, modulation, coefficient design and state handling shared by the plugin and its tools
+  license:            MIT
+
+  dependencies:       juce_audio_processors juce_dsp
+
+ END_JUCE_MODULE_DECLARATION
+*******************************************************************************/
+
+#pragma once
+
+//Compiles the DSP sources in Source/ once for every project that adds this module: the plugin, the render tool, the
+//benchmarks and the checks. A new DSP source only needs adding to funky_filter_dsp.cpp. Projects include the headers
+//from Source/ directly, so this header only brings in the JUCE modules they build on. The processor and the editor
+//stay in each project's own files, and the headless tools leave the editor out (see FUNKYFILTER_HEADLESS).
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
@@ -0,0 +1,267 @@
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "OfflinePlayHead.h"
+
+//==============================================================================
+//Renders audio files through FunkyFilterAudioProcessor without a plugin host, as fast as the CPU allows.
+//Many files are spread across a pool of worker threads, each of which owns one processor instance.
+namespace
+{
+    struct RenderOptions
+    {
+        juce::Array<juce::File> inputs;
+        juce::File outputFolder;
+        juce::StringPairArray parameters;
+        double bpm = 120.0;
+        int blockSize = 512;
+        int numJobs = juce::SystemStats::getNumCpus();
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: FunkyFilterRender [options] <input files...>" << std::endl
+                  << std::endl
+                  << "  -o, --output <folder>    Where to write the results (default: next to each input)" << std::endl
+                  << "  --bpm <value>            Transport tempo reported to the processor (default: 120)" << std::endl
+                  << "  --block-size <samples>   Processing block size (default: 512)" << std::endl
+                  << "  --jobs <count>           Worker threads for batch rendering (default: all cores)" << std::endl
+                  << "  --<ParameterID> <value>  Any plugin parameter in its own units, e.g. --FilterQuality 4" << std::endl
+                  << "                           (choices and toggles take their index, e.g. --UseNoteDuration 1)" << std::endl;
+    }
+
+    //Returns an error message, or an empty string if the arguments were valid
+    juce::String parseArguments(const juce::StringArray& arguments, RenderOptions& options)
+    {
+        for (int i = 0; i < arguments.size(); ++i)
+        {
+            const auto& argument = arguments[i];
+
+            if (! argument.startsWith("-"))
+            {
+                options.inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(argument));
+                continue;
+            }
+
+            // Options accept both "--name value" and "--name=value"
+            auto name = argument.trimCharactersAtStart("-").upToFirstOccurrenceOf("=", false, false);
+            juce::String value;
+
+            if (argument.contains("="))
+                value = argument.fromFirstOccurrenceOf("=", false, false);
+            else if (i + 1 < arguments.size())
+                value = arguments[++i];
+            else
+                return "Missing value for " + argument;
+
+            if (name == "o" || name == "output")
+                options.outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (name == "bpm")
+                options.bpm = value.getDoubleValue();
+            else if (name == "block-size")
+                options.blockSize = value.getIntValue();
+            else if (name == "jobs")
+                options.numJobs = value.getIntValue();
+            else
+                options.parameters.set(name, value);
+        }
+
+        if (options.inputs.isEmpty())
+            return "No input files given";
+
+        if (options.bpm <= 0 || options.blockSize <= 0 || options.numJobs <= 0)
+            return "--bpm, --block-size and --jobs must be positive";
+
+        return {};
+    }
+
+    //Returns an error message, or an empty string if every parameter exists
+    juce::String applyParameters(FunkyFilterAudioProcessor& processor, const juce::StringPairArray& parameters)
+    {
+        for (auto& parameterID : parameters.getAllKeys())
+        {
+            auto* parameter = processor.tree.getParameter(parameterID);
+
+            if (parameter == nullptr)
+                return "Unknown parameter " + parameterID;
+
+            const auto value = parameters[parameterID].getFloatValue();
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+
+        return {};
+    }
+
+    juce::File getOutputFile(const juce::File& input, const RenderOptions& options)
+    {
+        auto folder = options.outputFolder == juce::File() ? input.getParentDirectory() : options.outputFolder;
+        return folder.getChildFile(input.getFileNameWithoutExtension() + "_FunkyFilter" + input.getFileExtension());
+    }
+
+    //==============================================================================
+    //Renders one file with the given processor, returns an error message or an empty string on success
+    juce::String renderFile(FunkyFilterAudioProcessor& processor, juce::AudioFormatManager& formats,
+                            const juce::File& input, const juce::File& output, const RenderOptions& options)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+
+        if (reader == nullptr)
+            return "Can't read " + input.getFullPathName();
+
+        const auto numChannels = (int)reader->numChannels;
+        const auto sampleRate = reader->sampleRate;
+
+        // Match the processor's main buses to the file; the sidechain stays disconnected, so the envelope follows the input
+        auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        if (channelSet.isDisabled())
+            channelSet = juce::AudioChannelSet::discreteChannels(numChannels);
+
+        auto layout = processor.getBusesLayout();
+        layout.inputBuses.getReference(0) = channelSet;
+        layout.outputBuses.getReference(0) = channelSet;
+
+        if (! processor.setBusesLayout(layout))
+            return juce::String(numChannels) + " channels aren't supported: " + input.getFullPathName();
+
+        auto* format = formats.findFormatForFileExtension(output.getFileExtension());
+        output.deleteFile();
+        auto stream = output.createOutputStream();
+
+        if (format == nullptr || stream == nullptr)
+            return "Can't write " + output.getFullPathName();
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels,
+                                                                                (int)reader->bitsPerSample, {}, 0));
+        if (writer == nullptr)
+            return "Can't write " + output.getFullPathName();
+
+        // The writer owns the stream from here on
+        stream.release();
+
+        OfflinePlayHead playHead(options.bpm);
+        playHead.prepare(sampleRate);
+
+        processor.setPlayHead(&playHead);
+        processor.setNonRealtime(true);
+        processor.setRateAndBufferSizeDetails(sampleRate, options.blockSize);
+        processor.prepareToPlay(sampleRate, options.blockSize);
+
+        juce::AudioBuffer<float> buffer(numChannels, options.blockSize);
+        juce::MidiBuffer midi;
+
+        // With oversampling the output lags the input by the reported latency, so the render runs that much past the
+        // end of the file (the reader fills it with silence) and drops as much from the start, like a host's bounce
+        const auto latency = (juce::int64)processor.getLatencySamples();
+        const auto renderLength = reader->lengthInSamples + latency;
+
+        for (juce::int64 position = 0; position < renderLength; position += options.blockSize)
+        {
+            const auto numSamples = (int)juce::jmin((juce::int64)options.blockSize, renderLength - position);
+
+            buffer.setSize(numChannels, numSamples, false, false, true);
+            reader->read(&buffer, 0, numSamples, position, true, true);
+
+            processor.processBlock(buffer, midi);
+
+            const auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples, latency - position);
+            writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip);
+            playHead.advance(numSamples);
+        }
+
+        processor.releaseResources();
+        processor.setPlayHead(nullptr);
+        return {};
+    }
+
+    //==============================================================================
+    //Pulls files from a shared queue until it's empty, rendering each with its own processor
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker(const RenderOptions& renderOptions, std::atomic<int>& queuePosition, std::atomic<int>& failureCount)
+            : juce::Thread("FunkyFilter Render"), options(renderOptions), nextInput(queuePosition), failures(failureCount)
+        {
+            formats.registerBasicFormats();
+        }
+
+        FunkyFilterAudioProcessor& getProcessor() noexcept { return processor; }
+
+        void run() override
+        {
+            for (auto index = nextInput++; index < options.inputs.size() && ! threadShouldExit(); index = nextInput++)
+            {
+                const auto input = options.inputs[index];
+                const auto output = getOutputFile(input, options);
+                const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+                auto error = renderFile(processor, formats, input, output, options);
+                const auto seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+                const juce::ScopedLock lock(getOutputLock());
+
+                if (error.isNotEmpty())
+                {
+                    ++failures;
+                    std::cerr << "Failed: " << error << std::endl;
+                }
+                else
+                {
+                    std::cout << "Rendered " << output.getFullPathName() << " in " << seconds << " s" << std::endl;
+                }
+            }
+        }
+
+    private:
+        const RenderOptions& options;
+        std::atomic<int>& nextInput;
+        std::atomic<int>& failures;
+        juce::AudioFormatManager formats;
+        FunkyFilterAudioProcessor processor;
+
+        static juce::CriticalSection& getOutputLock()
+        {
+            static juce::CriticalSection lock;
+            return lock;
+        }
+    };
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // The processor's parameter tree expects a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderOptions options;
+    auto error = parseArguments(juce::StringArray(argv + 1, argc - 1), options);
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << std::endl << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    // One processor per worker, all created and configured here on the message thread
+    std::atomic<int> nextInput{ 0 }, failures{ 0 };
+    juce::OwnedArray<RenderWorker> workers;
+
+    for (int i = 0; i < juce::jmin(options.numJobs, options.inputs.size()); ++i)
+    {
+        auto* worker = workers.add(new RenderWorker(options, nextInput, failures));
+        error = applyParameters(worker->getProcessor(), options.parameters);
+
+        if (error.isNotEmpty())
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    for (auto* worker : workers)
+        worker->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit(-1);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Play head for rendering outside a host: the transport plays at a fixed tempo, and the position advances by however
+//many samples have been processed. It can also be stopped or set to loop, like a host's, for the regression checks.
+class OfflinePlayHead : public juce::AudioPlayHead
+{
+public:
+    explicit OfflinePlayHead(double tempo = 120.0) : bpm(tempo) {}
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        samplePosition = 0;
+    }
+
+    void advance(int numSamples) noexcept
+    {
+        if (playing)
+            samplePosition += numSamples;
+    }
+
+    //While stopped, the position stays where it is
+    void setPlaying(bool shouldBePlaying) noexcept
+    {
+        playing = shouldBePlaying;
+    }
+
+    //Once the position reaches the loop end (in quarter notes), it wraps back to the loop start
+    void setLoop(bool shouldLoop, double loopStartPpq = 0.0, double loopEndPpq = 0.0) noexcept
+    {
+        looping = shouldLoop && loopEndPpq > loopStartPpq;
+        loopPoints = { loopStartPpq, loopEndPpq };
+    }
+
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        const auto seconds = (double)samplePosition / sampleRate;
+        auto ppqPosition = seconds * bpm / 60.0;
+
+        if (looping && ppqPosition >= loopPoints.ppqEnd)
+            ppqPosition = loopPoints.ppqStart + std::fmod(ppqPosition - loopPoints.ppqStart, loopPoints.ppqEnd - loopPoints.ppqStart);
+
+        PositionInfo info;
+        info.setIsPlaying(playing);
+        info.setIsLooping(looping);
+        info.setLoopPoints(loopPoints);
+        info.setBpm(bpm);
+        info.setTimeSignature(juce::AudioPlayHead::TimeSignature{});
+        info.setTimeInSamples(samplePosition);
+        info.setTimeInSeconds(seconds);
+        info.setPpqPosition(ppqPosition);
+        return info;
+    }
+
+private:
+    double bpm, sampleRate = 44100.0;
+    juce::int64 samplePosition = 0;
+    bool playing = true, looping = false;
+    juce::AudioPlayHead::LoopPoints loopPoints;
+};
@@ -0,0 +1,126 @@
+#include "BiquadBank.h"
+
+//==============================================================================
+template <typename SampleType>
+void BiquadBank<SampleType>::prepare(int maximumChannels)
+{
+    numChannels = maximumChannels;
+
+    state1.assign((size_t)(numChannels * maximumGroups), Vector::expand(SampleType(0)));
+    state2.assign((size_t)(numChannels * maximumGroups), Vector::expand(SampleType(0)));
+}
+
+template <typename SampleType>
+void BiquadBank<SampleType>::reset()
+{
+    std::fill(state1.begin(), state1.end(), Vector::expand(SampleType(0)));
+    std::fill(state2.begin(), state2.end(), Vector::expand(SampleType(0)));
+}
+
+template <typename SampleType>
+void BiquadBank<SampleType>::setCoefficients(const SampleType* newCoefficients, int numVoices) noexcept
+{
+    gather(coefficients, newCoefficients, numVoices);
+    activeVoices = numVoices;
+}
+
+//Transposes voice-by-voice coefficients into one vector per term and group, zeroing the unused voices
+template <typename SampleType>
+void BiquadBank<SampleType>::gather(Coefficients& destination, const SampleType* source, int numVoices) noexcept
+{
+    jassert(numVoices <= maximumVoices);
+
+    for (auto& term : destination)
+        std::fill(term.begin(), term.end(), Vector::expand(SampleType(0)));
+
+    for (int voice = 0; voice < numVoices; ++voice)
+        for (int k = 0; k < 5; ++k)
+            reinterpret_cast<SampleType*>(destination[(size_t)k].data() + voice / lanes)[voice % lanes] = source[voice * 5 + k];
+}
+
+//==============================================================================
+template <typename SampleType>
+template <int numGroups>
+void BiquadBank<SampleType>::processGroups(SampleType* samples, int channel, int numSamples, const Coefficients& step) noexcept
+{
+    Vector b0[numGroups], b1[numGroups], b2[numGroups], a1[numGroups], a2[numGroups], s1[numGroups], s2[numGroups];
+    auto* channelState1 = state1.data() + channel * maximumGroups;
+    auto* channelState2 = state2.data() + channel * maximumGroups;
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        b0[g] = coefficients[0][(size_t)g]; b1[g] = coefficients[1][(size_t)g]; b2[g] = coefficients[2][(size_t)g];
+        a1[g] = coefficients[3][(size_t)g]; a2[g] = coefficients[4][(size_t)g];
+        s1[g] = channelState1[g];
+        s2[g] = channelState2[g];
+    }
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        // Every voice sees the same input, so it's broadcast once and the voices' outputs summed across the lanes
+        const auto input = Vector::expand(samples[n]);
+        auto sum = Vector::expand(SampleType(0));
+
+        for (int g = 0; g < numGroups; ++g)
+        {
+            b0[g] += step[0][(size_t)g]; b1[g] += step[1][(size_t)g]; b2[g] += step[2][(size_t)g];
+            a1[g] += step[3][(size_t)g]; a2[g] += step[4][(size_t)g];
+
+            const auto output = s1[g] + input * b0[g];
+
+            s1[g] = s2[g] + input * b1[g] - output * a1[g];
+            s2[g] = input * b2[g] - output * a2[g];
+
+            sum += output;
+        }
+
+        samples[n] = sum.sum();
+    }
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        channelState1[g] = s1[g];
+        channelState2[g] = s2[g];
+    }
+}
+
+template <typename SampleType>
+void BiquadBank<SampleType>::process(SampleType* const* channels, int numChannelsToProcess, int startSample, int numSamples,
+                                     const SampleType* targetCoefficients, int numVoices) noexcept
+{
+    jassert(numChannelsToProcess <= numChannels);
+
+    Coefficients target, step;
+    gather(target, targetCoefficients, numVoices);
+
+    const auto scale = Vector::expand(SampleType(1) / (SampleType)numSamples);
+
+    for (size_t k = 0; k < 5; ++k)
+        for (size_t g = 0; g < (size_t)maximumGroups; ++g)
+            step[k][g] = (target[k][g] - coefficients[k][g]) * scale;
+
+    // Only the groups holding a voice that is sounding, or ramping in or out, need any work
+    const auto numGroups = (juce::jmax(activeVoices, numVoices) + lanes - 1) / lanes;
+
+    for (int channel = 0; channel < numChannelsToProcess; ++channel)
+    {
+        auto* samples = channels[channel] + startSample;
+
+        switch (numGroups)
+        {
+            case 0:  break;
+            case 1:  processGroups<1>(samples, channel, numSamples, step); break;
+            case 2:  processGroups<juce::jmin(2, maximumGroups)>(samples, channel, numSamples, step); break;
+            case 3:  processGroups<juce::jmin(3, maximumGroups)>(samples, channel, numSamples, step); break;
+            default: processGroups<maximumGroups>(samples, channel, numSamples, step); break;
+        }
+    }
+
+    // Land exactly on the target so rounding errors don't accumulate across ramps
+    coefficients = target;
+    activeVoices = numVoices;
+}
+
+//==============================================================================
+template class BiquadBank<float>;
+template class BiquadBank<double>;
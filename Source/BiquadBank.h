@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Bank of parallel transposed direct form II biquads (one per voice) whose outputs are summed, for formant-style motion.
+//The voices are laid out structure-of-arrays: every coefficient and state term is a juce::dsp::SIMDRegister holding one
+//voice per lane, so each input sample is broadcast once and all voices step in a single vector pass. With lanes of four
+//floats a four-voice bank costs about as much per channel as MultichannelBiquad's single band.
+//Instantiated for float and double in BiquadBank.cpp.
+//Voices beyond the requested count have all-zero coefficients and stay silent, so adding or removing voices simply
+//ramps their coefficients in from or out to zero.
+template <typename SampleType>
+class BiquadBank
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int lanes = (int)Vector::SIMDNumElements;
+    static constexpr int maximumVoices = 8;
+    static constexpr int maximumGroups = (maximumVoices + lanes - 1) / lanes;
+
+    //==============================================================================
+    //Allocates the per-channel state, nothing is allocated after this
+    void prepare(int maximumChannels);
+    void reset();
+
+    //Jumps straight to the given coefficients, five (b0, b1, b2, a1, a2) per voice, without ramping
+    void setCoefficients(const SampleType* newCoefficients, int numVoices) noexcept;
+
+    //==============================================================================
+    //Filters a stretch of every channel in place, ramping each voice linearly towards its target over the stretch
+    void process(SampleType* const* channels, int numChannels, int startSample, int numSamples,
+                 const SampleType* targetCoefficients, int numVoices) noexcept;
+
+private:
+    //==============================================================================
+    using Coefficients = std::array<std::array<Vector, maximumGroups>, 5>;
+
+    int numChannels = 0, activeVoices = 0;
+    Coefficients coefficients{};
+
+    //One state pair per group of voices per channel, stored channel by channel
+    std::vector<Vector> state1, state2;
+
+    static void gather(Coefficients& destination, const SampleType* source, int numVoices) noexcept;
+
+    template <int numGroups>
+    void processGroups(SampleType* samples, int channel, int numSamples, const Coefficients& step) noexcept;
+
+    JUCE_LEAK_DETECTOR(BiquadBank)
+};
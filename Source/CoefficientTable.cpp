@@ -0,0 +1,120 @@
+#include "CoefficientTable.h"
+#include "FilterDesign.h"
+
+//==============================================================================
+CoefficientTable::QualityPoint CoefficientTable::getQualityPoint(float filterQuality) noexcept
+{
+    // The Q axis is spaced logarithmically, like the FilterQuality parameter's skew
+    const auto axisPosition = std::log(filterQuality / minimumQuality) / std::log(maximumQuality / minimumQuality) * (numQualities - 1);
+    const auto clamped = juce::jlimit(0.f, (float)(numQualities - 1), axisPosition);
+
+    QualityPoint point;
+    point.index = juce::jmin((int)clamped, numQualities - 2);
+    point.fraction = clamped - point.index;
+    return point;
+}
+
+bool CoefficientTable::matches(float minimum, float maximum, double rate) const noexcept
+{
+    return minimumFrequency == minimum && maximumFrequency == maximum && sampleRate == rate;
+}
+
+void CoefficientTable::build(float minimum, float maximum, double rate)
+{
+    for (int q = 0; q < numQualities; ++q)
+    {
+        const auto filterQuality = minimumQuality * std::pow(maximumQuality / minimumQuality, (float)q / (numQualities - 1));
+
+        for (int i = 0; i <= numPositions; ++i)
+        {
+            const auto filterFrequency = juce::mapToLog10((float)i / numPositions, minimum, maximum);
+            makeBandPassFilter(coefficients[q][i].data(), filterFrequency, filterQuality, rate);
+        }
+    }
+
+    minimumFrequency = minimum;
+    maximumFrequency = maximum;
+    sampleRate = rate;
+}
+
+template <typename SampleType>
+void CoefficientTable::lookup(SampleType* c, float position, QualityPoint qualityPoint) const noexcept
+{
+    const auto x = juce::jlimit(0.f, 1.f, position) * numPositions;
+    const auto i = juce::jmin((int)x, numPositions - 1);
+    const auto fraction = x - i;
+
+    const auto& lower = coefficients[qualityPoint.index];
+    const auto& upper = coefficients[qualityPoint.index + 1];
+
+    for (int k = 0; k < 5; ++k)
+    {
+        const auto low = lower[i][k] + fraction * (lower[i + 1][k] - lower[i][k]);
+        const auto high = upper[i][k] + fraction * (upper[i + 1][k] - upper[i][k]);
+        c[k] = (SampleType)(low + qualityPoint.fraction * (high - low));
+    }
+}
+
+template void CoefficientTable::lookup<float>(float*, float, QualityPoint) const noexcept;
+template void CoefficientTable::lookup<double>(double*, float, QualityPoint) const noexcept;
+
+//==============================================================================
+SharedCoefficientTables::SharedCoefficientTables()
+{
+    thread.startThread();
+}
+
+SharedCoefficientTables::~SharedCoefficientTables()
+{
+    thread.stopThread(1000);
+}
+
+std::shared_ptr<const CoefficientTable> SharedCoefficientTables::getTable(float minimum, float maximum, double rate)
+{
+    // Forget tables that every instance has let go of
+    tables.erase(std::remove_if(tables.begin(), tables.end(), [](const auto& table) { return table.expired(); }), tables.end());
+
+    for (const auto& weakTable : tables)
+        if (auto table = weakTable.lock(); table != nullptr && table->matches(minimum, maximum, rate))
+            return table;
+
+    auto table = std::make_shared<CoefficientTable>();
+    table->build(minimum, maximum, rate);
+    tables.push_back(table);
+    return table;
+}
+
+//==============================================================================
+CoefficientTableCache::CoefficientTableCache(SharedCoefficientTables& s) : sharedTables(s)
+{
+}
+
+const CoefficientTable* CoefficientTableCache::getTable(float minimumFrequency, float maximumFrequency, double sampleRate) noexcept
+{
+    requestedMinimumFrequency.store(minimumFrequency, std::memory_order_relaxed);
+    requestedMaximumFrequency.store(maximumFrequency, std::memory_order_relaxed);
+    requestedSampleRate.store(sampleRate, std::memory_order_relaxed);
+
+    tables.acquire();
+    const auto* table = tables.getReadBuffer().get();
+    return table != nullptr && table->matches(minimumFrequency, maximumFrequency, sampleRate) ? table : nullptr;
+}
+
+int CoefficientTableCache::useTimeSlice()
+{
+    const auto minimum = requestedMinimumFrequency.load(std::memory_order_relaxed);
+    const auto maximum = requestedMaximumFrequency.load(std::memory_order_relaxed);
+    const auto rate = requestedSampleRate.load(std::memory_order_relaxed);
+
+    if (rate > 0 && (minimum != builtMinimumFrequency || maximum != builtMaximumFrequency || rate != builtSampleRate))
+    {
+        tables.getWriteBuffer() = sharedTables.getTable(minimum, maximum, rate);
+        tables.publish();
+
+        builtMinimumFrequency = minimum;
+        builtMaximumFrequency = maximum;
+        builtSampleRate = rate;
+    }
+
+    return 20;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+//Band-pass coefficients precomputed over a grid of LFO positions and Q values, for one frequency range and sample rate.
+//The LFO position is the normalised (0 to 1) value that is mapped logarithmically between the minimum and maximum
+//frequency, so the table stays valid whatever shape produced it.
+struct CoefficientTable
+{
+    static constexpr int numPositions = 128, numQualities = 32;
+    static constexpr float minimumQuality = 0.1f, maximumQuality = 10.0f;
+
+    //Where a Q value falls on the coarse Q axis, computed once per block since Q doesn't change within it
+    struct QualityPoint
+    {
+        int index{ 0 };
+        float fraction{ 0 };
+    };
+
+    static QualityPoint getQualityPoint(float filterQuality) noexcept;
+
+    bool matches(float minimumFrequency, float maximumFrequency, double sampleRate) const noexcept;
+    void build(float minimumFrequency, float maximumFrequency, double sampleRate);
+
+    //Bilinearly interpolates the b0, b1, b2, a1, a2 terms for the given LFO position into c (instantiated for float and double)
+    template <typename SampleType>
+    void lookup(SampleType* c, float position, QualityPoint qualityPoint) const noexcept;
+
+    float minimumFrequency{ 0 }, maximumFrequency{ 0 };
+    double sampleRate{ 0 };
+
+    //One extra position so interpolation at the top of the range never reads past the end
+    std::array<std::array<std::array<float, 5>, numPositions + 1>, numQualities> coefficients{};
+};
+
+//Process-wide store of built tables, held through juce::SharedResourcePointer so every plugin instance in the process
+//shares one background thread and one copy of each table. Tables are immutable once built and keyed by frequency range
+//and sample rate, so instances with the same settings attach to the existing table instead of building their own.
+//A table is freed once no instance uses it any more.
+class SharedCoefficientTables
+{
+public:
+    SharedCoefficientTables();
+    ~SharedCoefficientTables();
+
+    juce::TimeSliceThread& getThread() noexcept { return thread; }
+
+    //Background thread only, so the store itself needs no locking: returns the table for these settings,
+    //building it if no instance holds one yet
+    std::shared_ptr<const CoefficientTable> getTable(float minimumFrequency, float maximumFrequency, double sampleRate);
+
+private:
+    juce::TimeSliceThread thread{ "FunkyFilter Coefficient Tables" };
+    std::vector<std::weak_ptr<const CoefficientTable>> tables;
+};
+
+//Keeps one instance's CoefficientTable in sync with its requested frequency range and sample rate.
+//The audio thread only records what it needs and picks up finished tables; fetching or building them happens
+//in useTimeSlice() on the shared background thread.
+class CoefficientTableCache : public juce::TimeSliceClient
+{
+public:
+    explicit CoefficientTableCache(SharedCoefficientTables& sharedTables);
+
+    //Audio thread: requests a table for the given range and returns the latest one if it matches, otherwise nullptr
+    const CoefficientTable* getTable(float minimumFrequency, float maximumFrequency, double sampleRate) noexcept;
+
+    //Background thread: fetches the shared table whenever the requested range differs from the last one fetched
+    int useTimeSlice() override;
+
+private:
+    SharedCoefficientTables& sharedTables;
+
+    //The references are only ever released by the background thread, when it overwrites its write slot
+    TripleBuffer<std::shared_ptr<const CoefficientTable>> tables;
+    std::atomic<float> requestedMinimumFrequency{ 0 }, requestedMaximumFrequency{ 0 };
+    std::atomic<double> requestedSampleRate{ 0 };
+
+    //Only touched by the background thread
+    float builtMinimumFrequency{ 0 }, builtMaximumFrequency{ 0 };
+    double builtSampleRate{ 0 };
+};
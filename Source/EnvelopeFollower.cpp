@@ -0,0 +1,127 @@
+#include "EnvelopeFollower.h"
+
+//==============================================================================
+template <typename SampleType>
+void EnvelopeFollower<SampleType>::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    detector.assign((size_t)maximumBlockSize, SampleType(0));
+    positions.assign((size_t)(maximumBlockSize / detectionStep + 2), 0.f);
+
+    reset();
+}
+
+template <typename SampleType>
+void EnvelopeFollower<SampleType>::reset() noexcept
+{
+    envelope = 0;
+    blockLength = numSteps = 0;
+    positions[0] = 0.f;
+}
+
+template <typename SampleType>
+void EnvelopeFollower<SampleType>::setParameters(float attackMilliseconds, float releaseMilliseconds, bool useRms) noexcept
+{
+    attackSamples = attackMilliseconds * 0.001 * sampleRate;
+    releaseSamples = releaseMilliseconds * 0.001 * sampleRate;
+    attackCoefficient = getCoefficient(attackSamples, detectionStep);
+    releaseCoefficient = getCoefficient(releaseSamples, detectionStep);
+
+    // A mean square and a peak amplitude aren't comparable, so switching detectors starts over
+    if (useRms != rms)
+        envelope = 0;
+
+    rms = useRms;
+}
+
+//How far a one-pole smoother with the given time constant moves towards its input over the given number of samples
+template <typename SampleType>
+SampleType EnvelopeFollower<SampleType>::getCoefficient(double timeSamples, int numSamples) noexcept
+{
+    return timeSamples > 0 ? (SampleType)(1.0 - std::exp(-numSamples / timeSamples)) : SampleType(1);
+}
+
+//==============================================================================
+template <typename SampleType>
+void EnvelopeFollower<SampleType>::process(const SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert(numSamples <= (int)detector.size());
+
+    // The new block starts where the last one ended
+    positions[0] = positions[(size_t)numSteps];
+    blockLength = numSamples;
+    numSteps = numChannels > 0 ? (numSamples + detectionStep - 1) / detectionStep : 0;
+
+    if (numSteps == 0)
+        return;
+
+    if (rms)
+    {
+        // Mean square across the channels, for the whole block at once
+        juce::FloatVectorOperations::multiply(detector.data(), channels[0], channels[0], numSamples);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::addWithMultiply(detector.data(), channels[channel], channels[channel], numSamples);
+
+        juce::FloatVectorOperations::multiply(detector.data(), SampleType(1) / (SampleType)numChannels, numSamples);
+    }
+
+    for (int step = 0; step < numSteps; ++step)
+    {
+        const auto start = step * detectionStep;
+        const auto length = juce::jmin(detectionStep, numSamples - start);
+        SampleType level = 0;
+
+        if (rms)
+        {
+            for (int n = start; n < start + length; ++n)
+                level += detector[(size_t)n];
+
+            level /= (SampleType)length;
+        }
+        else
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(channels[channel] + start, length);
+                level = juce::jmax(level, -range.getStart(), range.getEnd());
+            }
+        }
+
+        // Only a short last step needs its own coefficient
+        const auto rising = level > envelope;
+        const auto coefficient = length == detectionStep ? (rising ? attackCoefficient : releaseCoefficient)
+                                                         : getCoefficient(rising ? attackSamples : releaseSamples, length);
+
+        envelope += (level - envelope) * coefficient;
+        positions[(size_t)step + 1] = getPositionForEnvelope();
+    }
+}
+
+template <typename SampleType>
+float EnvelopeFollower<SampleType>::getPosition(int sample) const noexcept
+{
+    if (numSteps == 0)
+        return positions[0];
+
+    // Between the ends of the steps either side of the sample
+    const auto step = juce::jlimit(0, numSteps - 1, sample / detectionStep);
+    const auto start = step * detectionStep;
+    const auto length = juce::jmin(detectionStep, blockLength - start);
+    const auto fraction = juce::jlimit(0.f, 1.f, (float)(sample - start) / (float)length);
+
+    return positions[(size_t)step] + (positions[(size_t)step + 1] - positions[(size_t)step]) * fraction;
+}
+
+//Maps the envelope's level in decibels linearly onto 0 to 1, so it sweeps the cutoff logarithmically like the LFO
+template <typename SampleType>
+float EnvelopeFollower<SampleType>::getPositionForEnvelope() const noexcept
+{
+    const auto decibels = (rms ? 10.f : 20.f) * std::log10(juce::jmax((float)envelope, 1.0e-12f));
+    return juce::jlimit(0.f, 1.f, 1.f - decibels / floorDecibels);
+}
+
+//==============================================================================
+template class EnvelopeFollower<float>;
+template class EnvelopeFollower<double>;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Envelope follower for the sidechain modulation source. Detection works on whole blocks: the channels are squared and
+//summed (RMS) with juce::FloatVectorOperations, or scanned for their peak a step at a time, and the attack/release
+//smoothing then runs once per detectionStep samples on each step's peak or mean square instead of once per sample.
+//The envelope is kept as a position from 0 (floorDecibels or quieter) to 1 (0 dBFS), the scale the LFO sweeps on,
+//and read back at any sample of the block by interpolating between steps.
+//Instantiated for float and double in EnvelopeFollower.cpp.
+template <typename SampleType>
+class EnvelopeFollower
+{
+public:
+    static constexpr int detectionStep = 16;
+    static constexpr float floorDecibels = -60.f;
+
+    //==============================================================================
+    //Allocates the detection storage for blocks of up to maximumBlockSize samples, nothing is allocated after this
+    void prepare(double newSampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    //Attack and release are the times the envelope takes to cover about 63% of a rise or a fall
+    void setParameters(float attackMilliseconds, float releaseMilliseconds, bool useRms) noexcept;
+
+    //==============================================================================
+    //Follows a block of the detector input, with every channel contributing to one envelope
+    void process(const SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    //Envelope position at the given sample of the last block processed, from 0 to 1
+    float getPosition(int sample) const noexcept;
+
+private:
+    //==============================================================================
+    double sampleRate = 44100.0;
+    double attackSamples = 0, releaseSamples = 0;
+    SampleType attackCoefficient = 1, releaseCoefficient = 1; // For a full detection step
+    bool rms = false;
+
+    SampleType envelope = 0; // Peak amplitude, or mean square with RMS detection
+    int blockLength = 0, numSteps = 0;
+
+    //Squared input summed over the channels, only used by RMS detection
+    std::vector<SampleType> detector;
+
+    //positions[0] is where the block started, positions[k] where step k ended
+    std::vector<float> positions{ 0.f };
+
+    static SampleType getCoefficient(double timeSamples, int numSamples) noexcept;
+    float getPositionForEnvelope() const noexcept;
+
+    JUCE_LEAK_DETECTOR(EnvelopeFollower)
+};
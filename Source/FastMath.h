@@ -0,0 +1,69 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Polynomial and rational stand-ins for the libm calls in the coefficient path, selected by the FastMath parameter.
+//With the cutoff recomputed every few samples, std::pow (LFO position to frequency) and std::tan (the bilinear
+//prewarp) are most of the cost of a coefficient update; these need no table, no branch on the input beyond a fold,
+//and stay far inside the precision the coefficients are rounded to anyway.
+//
+//Error bounds, checked over 20 Hz to 20 kHz at 44.1 to 192 kHz and Q from 0.1 to 10 by the benchmark's check suite:
+// - cutoff: within maximumCutoffError of the exact design (relative, about 0.002 cents)
+// - gain: the magnitude response within maximumGainErrorDecibels of the exact one at every frequency in the range
+struct FastMath
+{
+    static constexpr double maximumCutoffError = 1.0e-6;
+    static constexpr double maximumGainErrorDecibels = 1.0e-3;
+
+    //2^x, from a degree 5 fit of 2^f over f in [0, 1] (relative error below 8e-8) scaled by 2^floor(x) through the
+    //exponent bits. The argument is split in double, since rounding it to float would cost more accuracy than the fit,
+    //and the polynomial is evaluated in Estrin's form to keep the dependency chain short. Clamped to the normal float range.
+    static float exp2(double x) noexcept
+    {
+        x = juce::jlimit(-126.0, 127.0, x);
+
+        auto integer = (int)x;
+        integer -= x < (double)integer ? 1 : 0;
+
+        const auto f = (float)(x - (double)integer);
+        const auto f2 = f * f;
+        const auto fraction = (0.99999993f + f * 0.69315297f)
+                            + f2 * ((0.24015453f + f * 0.05582360f) + f2 * (0.00899258f + f * 0.00187623f));
+
+        const auto exponentBits = (juce::int32)((integer + 127) << 23);
+        float scale;
+        std::memcpy(&scale, &exponentBits, sizeof(scale));
+
+        return fraction * scale;
+    }
+
+    //10^x, for mapping an LFO position between two log10 frequencies
+    static float exp10(float x) noexcept
+    {
+        return exp2((double)x * 3.3219280948873623); // log2(10)
+    }
+
+    //tan(x) for 0 <= x < pi / 2, such as the prewarp angle pi * f / sr, as a ratio so callers can fold the division
+    //into their own. Above pi / 4 it's folded onto the complementary angle (tan x = 1 / tan(pi / 2 - x)), and below
+    //that the [5/4] Pade approximant is within 1.4e-8 of tan.
+    static void getTanRatio(double x, double& numerator, double& denominator) noexcept
+    {
+        constexpr auto quarterPi = juce::MathConstants<double>::pi / 4.0;
+        const auto folded = x > quarterPi;
+        const auto y = folded ? 2.0 * quarterPi - x : x;
+        const auto z = y * y;
+
+        const auto p = y * (945.0 + z * (-105.0 + z));
+        const auto q = 945.0 + z * (-420.0 + z * 15.0);
+
+        numerator = folded ? q : p;
+        denominator = folded ? p : q;
+    }
+
+    static double tan(double x) noexcept
+    {
+        double numerator, denominator;
+        getTanRatio(x, numerator, denominator);
+        return numerator / denominator;
+    }
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+#include "MultichannelSVF.h"
+
+//Coefficient design for the filter engines, shared by the processor, the coefficient table and the tools:
+//LFO position to cutoff, cutoff to biquad coefficients or state variable parameters, and the filter's decay time.
+
+//Highest cutoff any filter is designed for, relative to the sample rate. The frequency parameters reach 16 kHz, which is
+//at or past Nyquist at sample rates of 32 kHz and below, where tan() (and with it the filter) would blow up.
+constexpr double maximumRelativeFrequency = 0.45;
+
+//pi * f / sr, the angle the bilinear transform prewarps with, for a cutoff kept clear of DC and Nyquist
+inline double getPrewarpAngle(double filterFrequency, double sampleRate)
+{
+    return juce::MathConstants<double>::pi * juce::jlimit(1.0, maximumRelativeFrequency * sampleRate, filterFrequency) / sampleRate;
+}
+
+//Maps a normalised LFO position to its cutoff, logarithmically between 10^logMinimumFrequency and
+//10^(logMinimumFrequency + logFrequencyRange), optionally through FastMath's exp10 instead of std::pow
+inline float mapPositionToFrequency(float position, float logMinimumFrequency, float logFrequencyRange, bool useFastMath = false)
+{
+    const auto logFrequency = logMinimumFrequency + position * logFrequencyRange;
+    return useFastMath ? FastMath::exp10(logFrequency) : std::pow(10.0f, logFrequency);
+}
+
+//Computes band-pass coefficients for the specified filter frequency, filter quality (Q factor), and sample rate.
+//Same design as juce::dsp::IIR::Coefficients::makeBandPass, but written into existing storage so nothing is allocated.
+//Computed in double and rounded to the sample type, since at low cutoffs a1 and a2 sit very close to -2 and 1.
+//With useFastMath the prewarp uses FastMath's tan approximation rather than std::tan, see FastMath for the error bounds.
+template <typename SampleType>
+inline void makeBandPassFilter(SampleType* c, double filterFrequency, float filterQuality, double sampleRate, bool useFastMath = false)
+{
+    const auto angle = getPrewarpAngle(filterFrequency, sampleRate);
+    const auto invQ = 1.0 / filterQuality;
+
+    if (useFastMath)
+    {
+        // With tan = t / u, n below is u / t; multiplied through by t^2 the whole design needs a single division
+        double t, u;
+        FastMath::getTanRatio(angle, t, u);
+
+        const auto scale = 1.0 / (t * t + invQ * t * u + u * u);
+
+        c[0] = (SampleType)(scale * t * u * invQ);
+        c[1] = (SampleType)0;
+        c[2] = (SampleType)(-scale * t * u * invQ);
+        c[3] = (SampleType)(scale * 2.0 * (t * t - u * u));
+        c[4] = (SampleType)(scale * (t * t - invQ * t * u + u * u));
+        return;
+    }
+
+    const auto n = 1.0 / std::tan(angle);
+    const auto nSquared = n * n;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    // Stored as b0, b1, b2, a1, a2 (a0 is normalised to 1)
+    c[0] = (SampleType)(c1 * n * invQ);
+    c[1] = (SampleType)0;
+    c[2] = (SampleType)(-c1 * n * invQ);
+    c[3] = (SampleType)(c1 * 2.0 * (1.0 - nSquared));
+    c[4] = (SampleType)(c1 * (1.0 - invQ * n + nSquared));
+}
+
+//Computes band-pass coefficients for two cutoffs together, such as the left and right channels' with StereoSpread.
+//Each stage is written across both lanes, so the compiler keeps the pair in one vector register (two doubles fill an
+//SSE2 or NEON register) and the design costs about what one does; lane by lane it's the same arithmetic as
+//makeBandPassFilter. Only std::tan, on the exact path, still runs once per lane.
+template <typename SampleType>
+inline void makeBandPassFilterPair(SampleType* left, SampleType* right, double leftFrequency, double rightFrequency,
+                                   float filterQuality, double sampleRate, bool useFastMath = false)
+{
+    constexpr int numLanes = 2;
+    const double frequencies[numLanes] = { leftFrequency, rightFrequency };
+    const auto invQ = 1.0 / filterQuality;
+    double angle[numLanes], c[5][numLanes];
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        angle[lane] = getPrewarpAngle(frequencies[lane], sampleRate);
+
+    if (useFastMath)
+    {
+        double t[numLanes], u[numLanes];
+
+        for (int lane = 0; lane < numLanes; ++lane)
+            FastMath::getTanRatio(angle[lane], t[lane], u[lane]);
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto scale = 1.0 / (t[lane] * t[lane] + invQ * t[lane] * u[lane] + u[lane] * u[lane]);
+
+            c[0][lane] = scale * t[lane] * u[lane] * invQ;
+            c[1][lane] = 0.0;
+            c[2][lane] = -scale * t[lane] * u[lane] * invQ;
+            c[3][lane] = scale * 2.0 * (t[lane] * t[lane] - u[lane] * u[lane]);
+            c[4][lane] = scale * (t[lane] * t[lane] - invQ * t[lane] * u[lane] + u[lane] * u[lane]);
+        }
+    }
+    else
+    {
+        double n[numLanes];
+
+        for (int lane = 0; lane < numLanes; ++lane)
+            n[lane] = 1.0 / std::tan(angle[lane]);
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto nSquared = n[lane] * n[lane];
+            const auto c1 = 1.0 / (1.0 + invQ * n[lane] + nSquared);
+
+            c[0][lane] = c1 * n[lane] * invQ;
+            c[1][lane] = 0.0;
+            c[2][lane] = -c1 * n[lane] * invQ;
+            c[3][lane] = c1 * 2.0 * (1.0 - nSquared);
+            c[4][lane] = c1 * (1.0 - invQ * n[lane] + nSquared);
+        }
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+        left[i] = (SampleType)c[i][0];
+        right[i] = (SampleType)c[i][1];
+    }
+}
+
+//Computes the state variable filter's parameters for the specified filter frequency, filter quality and sample rate:
+//g = tan(pi * f / sr) and k = 1 / Q. This one tan is the whole cost of a cutoff change with the SVF engine.
+template <typename SampleType>
+inline void makeStateVariableParameters(SampleType* p, double filterFrequency, float filterQuality, double sampleRate, bool useFastMath = false)
+{
+    const auto angle = getPrewarpAngle(filterFrequency, sampleRate);
+    p[0] = (SampleType)(useFastMath ? FastMath::tan(angle) : std::tan(angle));
+    p[1] = (SampleType)(1.0 / filterQuality);
+}
+
+//makeStateVariableParameters for two cutoffs together, written across both lanes like makeBandPassFilterPair
+template <typename SampleType>
+inline void makeStateVariableParameterPair(SampleType* left, SampleType* right, double leftFrequency, double rightFrequency,
+                                           float filterQuality, double sampleRate, bool useFastMath = false)
+{
+    constexpr int numLanes = 2;
+    const double frequencies[numLanes] = { leftFrequency, rightFrequency };
+    double g[numLanes];
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        const auto angle = getPrewarpAngle(frequencies[lane], sampleRate);
+        g[lane] = useFastMath ? FastMath::tan(angle) : std::tan(angle);
+    }
+
+    left[0] = (SampleType)g[0];
+    right[0] = (SampleType)g[1];
+    left[1] = right[1] = (SampleType)(1.0 / filterQuality);
+}
+
+//Computes the biquad (b0, b1, b2, a1, a2) with the same response as the state variable filter's selected output,
+//so it can be drawn. The SVF is the bilinear transform of the analog prototypes, prewarped at the cutoff.
+inline void makeStateVariableResponse(float* c, double filterFrequency, float filterQuality, double sampleRate, int output)
+{
+    const auto g = std::tan(getPrewarpAngle(filterFrequency, sampleRate));
+    const auto gSquared = g * g;
+    const auto k = 1.0 / filterQuality;
+    const auto a0 = 1.0 + g * k + gSquared;
+
+    double b[3];
+
+    switch (output)
+    {
+        case lowPassOutput:  b[0] = gSquared;       b[1] = 2.0 * gSquared;         b[2] = gSquared;       break;
+        case highPassOutput: b[0] = 1.0;            b[1] = -2.0;                   b[2] = 1.0;            break;
+        case notchOutput:    b[0] = 1.0 + gSquared; b[1] = 2.0 * (gSquared - 1.0); b[2] = 1.0 + gSquared; break;
+        default:             b[0] = g * k;          b[1] = 0.0;                    b[2] = -g * k;         break;
+    }
+
+    c[0] = (float)(b[0] / a0);
+    c[1] = (float)(b[1] / a0);
+    c[2] = (float)(b[2] / a0);
+    c[3] = (float)(2.0 * (gSquared - 1.0) / a0);
+    c[4] = (float)((1.0 - g * k + gSquared) / a0);
+}
+
+//Number of samples it takes the filter's ringing to decay by the given number of decibels, from its slowest pole.
+//The biquad and the state variable filter have the same poles for every output, so this covers both engines.
+inline double getFilterDecaySamples(double filterFrequency, float filterQuality, double sampleRate, double decibels)
+{
+    double c[5];
+    makeBandPassFilter(c, filterFrequency, filterQuality, sampleRate);
+
+    // Poles of z^2 + a1 z + a2: a complex pair has radius sqrt(a2), a real pair (Q below 0.5) is solved directly
+    const double a1 = c[3], a2 = c[4];
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+    const auto poleRadius = discriminant < 0.0 ? std::sqrt(a2)
+                                               : (std::abs(a1) + std::sqrt(discriminant)) / 2.0;
+
+    if (poleRadius <= 0.0)
+        return 0.0;
+
+    if (poleRadius >= 1.0)
+        return std::numeric_limits<double>::infinity();
+
+    // Near Q = 0.5 the poles (almost) coincide and the response decays like n * r^n rather than r^n,
+    // which takes up to about a fifth longer, so leave a margin
+    return 1.25 * decibels / (-20.0 * std::log10(poleRadius));
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Bank of LFO shapes (sine, triangle, saw, square and sample & hold) generated entirely by the compiler.
+//Every shape maps a phase to a position between the minimum (0) and maximum (1) frequency, and starts at the
+//top like the original cosine. The saw, square and sample & hold edges are rounded off over a short stretch of
+//the cycle, so the cutoff never jumps from one end of the range to the other between two samples.
+//Tables are fixed size and cache-line aligned, so there's no work at startup and no per-instance memory.
+class LfoShapeBank
+{
+public:
+    //Same order as the LfoShape parameter
+    enum Shape
+    {
+        sine,
+        triangle,
+        saw,
+        square,
+        sampleAndHold,
+        numShapes
+    };
+
+    static constexpr int tableSize = 512;
+
+    //Sample & hold picks a new value every LFO cycle, so its table holds a sequence of steps that repeats
+    //after this many cycles; every other table holds exactly one cycle
+    static constexpr int sampleAndHoldSteps = 16;
+
+    static constexpr int getCyclesPerTable(int shape) noexcept
+    {
+        return shape == sampleAndHold ? sampleAndHoldSteps : 1;
+    }
+
+    //Reads a shape at a phase in [0, 1) of its table, with cubic (Catmull-Rom) interpolation
+    static float lookup(int shape, double phase) noexcept;
+
+    //==============================================================================
+    //The exact shape at a phase in [0, 1) of its table, used to build the tables at compile time
+    static constexpr double getValue(int shape, double phase) noexcept
+    {
+        switch (shape)
+        {
+            case triangle: return phase < 0.5 ? 1.0 - 2.0 * phase : 2.0 * phase - 1.0;
+            case saw: return getSaw(phase);
+            case square: return getSquare(phase);
+            case sampleAndHold: return getSampleAndHold(phase);
+            default: return (getCosine(phase) + 1.0) / 2.0;
+        }
+    }
+
+    //Table with one guard point before and two after the cycle, so interpolation never has to wrap
+    struct alignas(64) Table
+    {
+        std::array<float, tableSize + 3> values;
+    };
+
+    static constexpr Table makeTable(int shape) noexcept
+    {
+        Table table{};
+
+        for (int i = 0; i < tableSize + 3; ++i)
+            table.values[(size_t)i] = (float)getValue(shape, (double)((i - 1 + tableSize) % tableSize) / tableSize);
+
+        return table;
+    }
+
+private:
+    //==============================================================================
+    //Width of the rounded edges, as a fraction of the cycle (or of one sample & hold step)
+    static constexpr double edgeWidth = 1.0 / 32.0, stepEdgeWidth = 1.0 / 8.0;
+
+    //Smoothstep from 0 to 1 over t in [0, 1]
+    static constexpr double smoothStep(double t) noexcept
+    {
+        t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+        return t * t * (3.0 - 2.0 * t);
+    }
+
+    //cos(2 pi x) for x in [0, 1), folded into the first quarter of the cycle where the Taylor series converges quickly
+    static constexpr double getCosine(double x) noexcept
+    {
+        auto t = x < 0.5 ? x : 1.0 - x;
+        auto sign = 1.0;
+
+        if (t > 0.25)
+        {
+            t = 0.5 - t;
+            sign = -1.0;
+        }
+
+        const auto thetaSquared = juce::MathConstants<double>::twoPi * t * juce::MathConstants<double>::twoPi * t;
+        auto sum = 1.0, term = 1.0;
+
+        for (int n = 1; n < 12; ++n)
+        {
+            term *= -thetaSquared / ((2.0 * n - 1.0) * (2.0 * n));
+            sum += term;
+        }
+
+        return sign * sum;
+    }
+
+    //Rising ramp that drops back to 0 at the end of the cycle, with the drop centred on the wrap
+    static constexpr double getSaw(double x) noexcept
+    {
+        if (x < edgeWidth / 2.0)
+        {
+            const auto blend = smoothStep(x / edgeWidth + 0.5);
+            return (x + 1.0) * (1.0 - blend) + x * blend;
+        }
+
+        if (x > 1.0 - edgeWidth / 2.0)
+        {
+            const auto blend = smoothStep((x - 1.0) / edgeWidth + 0.5);
+            return x * (1.0 - blend) + (x - 1.0) * blend;
+        }
+
+        return x;
+    }
+
+    //High for the first half of the cycle and low for the second, with the edges centred on 0 and 0.5
+    static constexpr double getSquare(double x) noexcept
+    {
+        if (x < 0.25)
+            return smoothStep(x / edgeWidth + 0.5);
+
+        if (x < 0.75)
+            return smoothStep((0.5 - x) / edgeWidth + 0.5);
+
+        return smoothStep((x - 1.0) / edgeWidth + 0.5);
+    }
+
+    //A fixed pseudo-random value for each step (from a linear congruential generator), so the table is deterministic
+    static constexpr double getRandomStep(int step) noexcept
+    {
+        juce::uint32 state = 0x2545f491u;
+
+        for (int i = 0; i <= (step + sampleAndHoldSteps) % sampleAndHoldSteps; ++i)
+            state = state * 1664525u + 1013904223u;
+
+        return (double)(state >> 8) / (double)(1u << 24);
+    }
+
+    //Holds each step's value, gliding briefly into it at the start of the step
+    static constexpr double getSampleAndHold(double x) noexcept
+    {
+        const auto position = x * sampleAndHoldSteps;
+        const auto step = (int)position;
+        const auto fraction = position - step;
+
+        if (fraction < 0.5)
+        {
+            const auto blend = smoothStep(fraction / stepEdgeWidth + 0.5);
+            return getRandomStep(step - 1) * (1.0 - blend) + getRandomStep(step) * blend;
+        }
+
+        const auto blend = smoothStep((fraction - 1.0) / stepEdgeWidth + 0.5);
+        return getRandomStep(step) * (1.0 - blend) + getRandomStep(step + 1) * blend;
+    }
+};
+
+//==============================================================================
+//The tables themselves, each built by the compiler in its own constant evaluation
+inline constexpr LfoShapeBank::Table lfoSineTable = LfoShapeBank::makeTable(LfoShapeBank::sine);
+inline constexpr LfoShapeBank::Table lfoTriangleTable = LfoShapeBank::makeTable(LfoShapeBank::triangle);
+inline constexpr LfoShapeBank::Table lfoSawTable = LfoShapeBank::makeTable(LfoShapeBank::saw);
+inline constexpr LfoShapeBank::Table lfoSquareTable = LfoShapeBank::makeTable(LfoShapeBank::square);
+inline constexpr LfoShapeBank::Table lfoSampleAndHoldTable = LfoShapeBank::makeTable(LfoShapeBank::sampleAndHold);
+
+inline constexpr const LfoShapeBank::Table* lfoShapeTables[LfoShapeBank::numShapes] = {
+    &lfoSineTable, &lfoTriangleTable, &lfoSawTable, &lfoSquareTable, &lfoSampleAndHoldTable
+};
+
+inline float LfoShapeBank::lookup(int shape, double phase) noexcept
+{
+    const auto& values = lfoShapeTables[juce::jlimit(0, numShapes - 1, shape)]->values;
+
+    const auto position = phase * tableSize;
+    const auto index = juce::jlimit(0, tableSize - 1, (int)position);
+    const auto fraction = (float)(position - index);
+
+    // values[index + 1] is the point at the index, thanks to the leading guard point
+    const auto y0 = values[(size_t)index], y1 = values[(size_t)index + 1];
+    const auto y2 = values[(size_t)index + 2], y3 = values[(size_t)index + 3];
+
+    const auto c1 = 0.5f * (y2 - y0);
+    const auto c2 = y0 - 2.5f * y1 + 2.f * y2 - 0.5f * y3;
+    const auto c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+
+    // The rounded edges span several points, so any overshoot is tiny, but the position must stay inside the range
+    return juce::jlimit(0.f, 1.f, ((c3 * fraction + c2) * fraction + c1) * fraction + y1);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//One modulation step as seen by the audio thread: where the cutoff was, where the LFO was,
+//and how loud the filtered output was over the samples of that step
+struct ModulationRecord
+{
+    float cutoff{ 0 }, phase{ 0 }, peak{ 0 }, rms{ 0 };
+};
+
+//Lock-free single-producer/single-consumer queue of modulation records, built on juce::AbstractFifo.
+//The audio thread pushes and the editor pops; if the editor falls behind, new records are dropped
+//instead of ever making the audio thread wait.
+class ModulationTelemetry
+{
+public:
+    static constexpr int capacity = 4096;
+
+    //The audio thread only gathers records while an editor is listening
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    //Audio thread
+    bool push(const ModulationRecord& record) noexcept
+    {
+        const auto scope = fifo.write(1);
+
+        if (scope.blockSize1 == 0)
+            return false;
+
+        records[(size_t)scope.startIndex1] = record;
+        return true;
+    }
+
+    //Message thread, calls the callback for every record waiting in the queue, oldest first
+    template <typename Callback>
+    int popAll(Callback&& callback)
+    {
+        const auto scope = fifo.read(fifo.getNumReady());
+        scope.forEach([&](int index) { callback(records[(size_t)index]); });
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+private:
+    juce::AbstractFifo fifo{ capacity };
+    std::array<ModulationRecord, capacity> records{};
+    std::atomic<bool> enabled{ false };
+};
@@ -0,0 +1,193 @@
+#include "MultichannelBiquad.h"
+
+//==============================================================================
+template <typename SampleType>
+void MultichannelBiquad<SampleType>::prepare(int maximumChannels, int maximumBlockSize)
+{
+    numGroups = (maximumChannels + lanes - 1) / lanes;
+    maximumSamples = maximumBlockSize;
+
+    state1.assign((size_t)numGroups, Vector::expand(SampleType(0)));
+    state2.assign((size_t)numGroups, Vector::expand(SampleType(0)));
+    interleaved.assign((size_t)(numGroups * maximumSamples), Vector::expand(SampleType(0)));
+
+    leftLanes.assign((size_t)numGroups, Vector::expand(SampleType(1)));
+    rightLanes.assign((size_t)numGroups, Vector::expand(SampleType(0)));
+    samePattern = true;
+}
+
+template <typename SampleType>
+void MultichannelBiquad<SampleType>::reset()
+{
+    std::fill(state1.begin(), state1.end(), Vector::expand(SampleType(0)));
+    std::fill(state2.begin(), state2.end(), Vector::expand(SampleType(0)));
+}
+
+template <typename SampleType>
+void MultichannelBiquad<SampleType>::setCoefficients(const SampleType* leftCoefficients, const SampleType* rightCoefficients) noexcept
+{
+    if (rightCoefficients == nullptr)
+        rightCoefficients = leftCoefficients;
+
+    std::copy(leftCoefficients, leftCoefficients + 5, coefficients[0].begin());
+    std::copy(rightCoefficients, rightCoefficients + 5, coefficients[1].begin());
+}
+
+template <typename SampleType>
+void MultichannelBiquad<SampleType>::setRightChannels(const juce::BigInteger& rightChannels) noexcept
+{
+    samePattern = true;
+
+    for (int group = 0; group < numGroups; ++group)
+    {
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const auto right = rightChannels[group * lanes + lane];
+            leftLanes[(size_t)group].set((size_t)lane, right ? SampleType(0) : SampleType(1));
+            rightLanes[(size_t)group].set((size_t)lane, right ? SampleType(1) : SampleType(0));
+        }
+
+        if (rightChannels.getBitRangeAsInt(group * lanes, lanes) != rightChannels.getBitRangeAsInt(0, lanes))
+            samePattern = false;
+    }
+}
+
+template <typename SampleType>
+typename MultichannelBiquad<SampleType>::Vector MultichannelBiquad<SampleType>::spread(int group, SampleType left, SampleType right) const noexcept
+{
+    // Scaling the masks by each side's value and adding puts it in that side's lanes, exactly
+    return leftLanes[(size_t)group] * left + rightLanes[(size_t)group] * right;
+}
+
+//==============================================================================
+template <typename SampleType>
+SampleType* MultichannelBiquad<SampleType>::getLane(int sample, int channel) noexcept
+{
+    return reinterpret_cast<SampleType*>(interleaved.data() + (channel / lanes) * maximumSamples + sample) + channel % lanes;
+}
+
+template <typename SampleType>
+const SampleType* MultichannelBiquad<SampleType>::getLane(int sample, int channel) const noexcept
+{
+    return reinterpret_cast<const SampleType*>(interleaved.data() + (channel / lanes) * maximumSamples + sample) + channel % lanes;
+}
+
+template <typename SampleType>
+void MultichannelBiquad<SampleType>::load(const SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert(numChannels <= numGroups * lanes);
+    jassert(numSamples <= maximumSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = channels[channel];
+        auto* destination = getLane(0, channel);
+
+        for (int n = 0; n < numSamples; ++n)
+            destination[n * lanes] = source[n];
+    }
+}
+
+template <typename SampleType>
+void MultichannelBiquad<SampleType>::store(SampleType* const* channels, int numChannels, int numSamples) const noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = getLane(0, channel);
+        auto* destination = channels[channel];
+
+        for (int n = 0; n < numSamples; ++n)
+            destination[n] = source[n * lanes];
+    }
+}
+
+template <typename SampleType>
+template <int groupsAtOnce, bool sharedSides>
+void MultichannelBiquad<SampleType>::processGroups(int firstGroup, int startSample, int numSamples, const SideCoefficients& step) noexcept
+{
+    // When every group has the same sides one set of vectors serves them all, otherwise each group ramps its own
+    constexpr int numSets = sharedSides ? 1 : groupsAtOnce;
+    Coefficients current[numSets], ramp[numSets];
+
+    for (int set = 0; set < numSets; ++set)
+    {
+        for (size_t i = 0; i < 5; ++i)
+        {
+            current[set][i] = spread(firstGroup + set, coefficients[0][i], coefficients[1][i]);
+            ramp[set][i] = spread(firstGroup + set, step[0][i], step[1][i]);
+        }
+    }
+
+    Vector s1[groupsAtOnce], s2[groupsAtOnce];
+    Vector* samples[groupsAtOnce];
+
+    for (int g = 0; g < groupsAtOnce; ++g)
+    {
+        s1[g] = state1[(size_t)(firstGroup + g)];
+        s2[g] = state2[(size_t)(firstGroup + g)];
+        samples[g] = interleaved.data() + (firstGroup + g) * maximumSamples + startSample;
+    }
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        for (int set = 0; set < numSets; ++set)
+            for (size_t i = 0; i < 5; ++i)
+                current[set][i] += ramp[set][i];
+
+        // Independent groups are interleaved here so their feedback loops overlap in the pipeline
+        for (int g = 0; g < groupsAtOnce; ++g)
+        {
+            const auto& c = current[sharedSides ? 0 : g];
+            const auto input = samples[g][n];
+            const auto output = s1[g] + input * c[0];
+
+            s1[g] = s2[g] + input * c[1] - output * c[3];
+            s2[g] = input * c[2] - output * c[4];
+
+            samples[g][n] = output;
+        }
+    }
+
+    for (int g = 0; g < groupsAtOnce; ++g)
+    {
+        state1[(size_t)(firstGroup + g)] = s1[g];
+        state2[(size_t)(firstGroup + g)] = s2[g];
+    }
+}
+
+template <typename SampleType>
+void MultichannelBiquad<SampleType>::process(int startSample, int numSamples, const SampleType* leftTargets, const SampleType* rightTargets) noexcept
+{
+    jassert(startSample + numSamples <= maximumSamples);
+
+    if (rightTargets == nullptr)
+        rightTargets = leftTargets;
+
+    SideCoefficients step;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        step[0][i] = (leftTargets[i] - coefficients[0][i]) / numSamples;
+        step[1][i] = (rightTargets[i] - coefficients[1][i]) / numSamples;
+    }
+
+    // Each pass keeps its state in registers for the whole segment; the ramp is cheap enough to redo per pass
+    int group = 0;
+
+    for (; group + 2 <= numGroups; group += 2)
+    {
+        if (samePattern)
+            processGroups<2, true>(group, startSample, numSamples, step);
+        else
+            processGroups<2, false>(group, startSample, numSamples, step);
+    }
+
+    if (group < numGroups)
+        processGroups<1, true>(group, startSample, numSamples, step);
+
+    // Land exactly on the target so rounding errors don't accumulate across ramps
+    setCoefficients(leftTargets, rightTargets);
+}
+
+//==============================================================================
+template class MultichannelBiquad<float>;
+template class MultichannelBiquad<double>;
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Transposed direct form II biquad that runs any number of channels through a shared coefficient set.
+//Channels are interleaved into juce::dsp::SIMDRegister lanes, so a stereo pair costs a single vector
+//operation per step and a 16-channel bus only four (with SSE/NEON lanes of four floats, or of two doubles).
+//Instantiated for float and double in MultichannelBiquad.cpp.
+//The coefficients can be ramped linearly per sample towards a new target, which keeps modulation smooth.
+//The left and right channels of a layout may have a coefficient set each; which lanes take the right side's set is
+//given by setRightChannels(), and every other channel (centre, LFE, ambisonic or discrete) takes the left side's.
+//While every group of lanes has the same sides, as with stereo, that costs nothing over a shared set.
+template <typename SampleType>
+class MultichannelBiquad
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int lanes = (int)Vector::SIMDNumElements;
+
+    //==============================================================================
+    //Allocates state and interleaving storage, nothing is allocated after this
+    void prepare(int maximumChannels, int maximumBlockSize);
+    void reset();
+
+    //Jumps straight to a coefficient set (b0, b1, b2, a1, a2) for the left side's channels and one for the right side's,
+    //without ramping. Without a set for the right side every channel shares the first.
+    void setCoefficients(const SampleType* leftCoefficients, const SampleType* rightCoefficients = nullptr) noexcept;
+
+    //Marks the channels that take the right side's set. prepare() starts every channel on the left side's; this doesn't
+    //allocate, but has to be called again after it.
+    void setRightChannels(const juce::BigInteger& rightChannels) noexcept;
+
+    //==============================================================================
+    //Copies channels into the SIMD lanes, processes them and copies them back.
+    //Call process() between load() and store() for each stretch of the block that shares one ramp.
+    void load(const SampleType* const* channels, int numChannels, int numSamples) noexcept;
+    void process(int startSample, int numSamples, const SampleType* leftTargets, const SampleType* rightTargets = nullptr) noexcept;
+    void store(SampleType* const* channels, int numChannels, int numSamples) const noexcept;
+
+private:
+    //==============================================================================
+    using Coefficients = std::array<Vector, 5>;
+    using SideCoefficients = std::array<std::array<SampleType, 5>, 2>;
+
+    int numGroups = 0, maximumSamples = 0;
+
+    //The left side's set, then the right side's
+    SideCoefficients coefficients{ { { 1.f, 0.f, 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f, 0.f, 0.f } } };
+
+    //One state pair per group of lanes, and the interleaved block stored group by group
+    std::vector<Vector> state1, state2, interleaved;
+
+    //Per group of lanes, 1 in the lanes of the left side's channels and 0 elsewhere, and the reverse for the right side.
+    //samePattern is whether every group has the same sides, so one set of vectors serves them all.
+    std::vector<Vector> leftLanes, rightLanes;
+    bool samePattern = true;
+
+    template <int groupsAtOnce, bool sharedSides>
+    void processGroups(int firstGroup, int startSample, int numSamples, const SideCoefficients& step) noexcept;
+
+    //A vector with the left value in the group's left lanes and the right value in its right lanes
+    Vector spread(int group, SampleType left, SampleType right) const noexcept;
+
+    SampleType* getLane(int sample, int channel) noexcept;
+    const SampleType* getLane(int sample, int channel) const noexcept;
+
+    JUCE_LEAK_DETECTOR(MultichannelBiquad)
+};
@@ -0,0 +1,282 @@
+#include "MultichannelSVF.h"
+
+//==============================================================================
+template <typename SampleType>
+void MultichannelSVF<SampleType>::prepare(int maximumChannels, int maximumBlockSize)
+{
+    numGroups = (maximumChannels + lanes - 1) / lanes;
+    maximumSamples = maximumBlockSize;
+
+    state1.assign((size_t)numGroups, Vector::expand(SampleType(0)));
+    state2.assign((size_t)numGroups, Vector::expand(SampleType(0)));
+    interleaved.assign((size_t)(numGroups * maximumSamples), Vector::expand(SampleType(0)));
+
+    leftLanes.assign((size_t)numGroups, Vector::expand(SampleType(1)));
+    rightLanes.assign((size_t)numGroups, Vector::expand(SampleType(0)));
+    samePattern = true;
+    anyRightChannels = false;
+}
+
+template <typename SampleType>
+void MultichannelSVF<SampleType>::reset()
+{
+    std::fill(state1.begin(), state1.end(), Vector::expand(SampleType(0)));
+    std::fill(state2.begin(), state2.end(), Vector::expand(SampleType(0)));
+}
+
+template <typename SampleType>
+void MultichannelSVF<SampleType>::setParameters(const SampleType* leftParameters, const SampleType* rightParameters) noexcept
+{
+    if (rightParameters == nullptr)
+        rightParameters = leftParameters;
+
+    std::copy(leftParameters, leftParameters + 2, parameters[0].begin());
+    std::copy(rightParameters, rightParameters + 2, parameters[1].begin());
+}
+
+template <typename SampleType>
+void MultichannelSVF<SampleType>::setRightChannels(const juce::BigInteger& rightChannels) noexcept
+{
+    samePattern = true;
+    anyRightChannels = false;
+
+    for (int group = 0; group < numGroups; ++group)
+    {
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const auto right = rightChannels[group * lanes + lane];
+            leftLanes[(size_t)group].set((size_t)lane, right ? SampleType(0) : SampleType(1));
+            rightLanes[(size_t)group].set((size_t)lane, right ? SampleType(1) : SampleType(0));
+            anyRightChannels = anyRightChannels || right;
+        }
+
+        if (rightChannels.getBitRangeAsInt(group * lanes, lanes) != rightChannels.getBitRangeAsInt(0, lanes))
+            samePattern = false;
+    }
+}
+
+template <typename SampleType>
+void MultichannelSVF<SampleType>::setOutput(int newOutput) noexcept
+{
+    // Input, k * band-pass and low-pass weights; high-pass is x - k * bp - lp and the notch is x - k * bp
+    switch (newOutput)
+    {
+        case lowPassOutput:  outputMix = { 0.f, 0.f, 1.f };   break;
+        case highPassOutput: outputMix = { 1.f, -1.f, -1.f }; break;
+        case notchOutput:    outputMix = { 1.f, -1.f, 0.f };  break;
+        default:             outputMix = { 0.f, 1.f, 0.f };   break;
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+SampleType* MultichannelSVF<SampleType>::getLane(int sample, int channel) noexcept
+{
+    return reinterpret_cast<SampleType*>(interleaved.data() + (channel / lanes) * maximumSamples + sample) + channel % lanes;
+}
+
+template <typename SampleType>
+const SampleType* MultichannelSVF<SampleType>::getLane(int sample, int channel) const noexcept
+{
+    return reinterpret_cast<const SampleType*>(interleaved.data() + (channel / lanes) * maximumSamples + sample) + channel % lanes;
+}
+
+template <typename SampleType>
+void MultichannelSVF<SampleType>::load(const SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert(numChannels <= numGroups * lanes);
+    jassert(numSamples <= maximumSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = channels[channel];
+        auto* destination = getLane(0, channel);
+
+        for (int n = 0; n < numSamples; ++n)
+            destination[n * lanes] = source[n];
+    }
+}
+
+template <typename SampleType>
+void MultichannelSVF<SampleType>::store(SampleType* const* channels, int numChannels, int numSamples) const noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = getLane(0, channel);
+        auto* destination = channels[channel];
+
+        for (int n = 0; n < numSamples; ++n)
+            destination[n] = source[n * lanes];
+    }
+}
+
+template <typename SampleType>
+template <int groupsAtOnce>
+void MultichannelSVF<SampleType>::processGroups(int firstGroup, int startSample, int numSamples, const Parameters& step) noexcept
+{
+    auto g = parameters[0][0], k = parameters[0][1];
+    const auto inputMix = outputMix[0], lowPassMix = outputMix[2];
+
+    Vector ic1[groupsAtOnce], ic2[groupsAtOnce];
+    Vector* samples[groupsAtOnce];
+
+    for (int group = 0; group < groupsAtOnce; ++group)
+    {
+        ic1[group] = state1[(size_t)(firstGroup + group)];
+        ic2[group] = state2[(size_t)(firstGroup + group)];
+        samples[group] = interleaved.data() + (firstGroup + group) * maximumSamples + startSample;
+    }
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        g += step[0][0];
+        k += step[0][1];
+
+        // The per-sample division is shared by every group, so it's amortised across the channels
+        const auto a1 = 1.f / (1.f + g * (g + k));
+        const auto a2 = g * a1;
+        const auto a3 = g * a2;
+        const auto bandPassMix = outputMix[1] * k;
+
+        // Independent groups are interleaved here so their feedback loops overlap in the pipeline
+        for (int group = 0; group < groupsAtOnce; ++group)
+        {
+            const auto input = samples[group][n];
+            const auto v3 = input - ic2[group];
+            const auto v1 = ic1[group] * a1 + v3 * a2;
+            const auto v2 = ic2[group] + ic1[group] * a2 + v3 * a3;
+
+            ic1[group] = v1 + v1 - ic1[group];
+            ic2[group] = v2 + v2 - ic2[group];
+
+            samples[group][n] = input * inputMix + v1 * bandPassMix + v2 * lowPassMix;
+        }
+    }
+
+    for (int group = 0; group < groupsAtOnce; ++group)
+    {
+        state1[(size_t)(firstGroup + group)] = ic1[group];
+        state2[(size_t)(firstGroup + group)] = ic2[group];
+    }
+}
+
+template <typename SampleType>
+template <int groupsAtOnce, bool sharedSides>
+void MultichannelSVF<SampleType>::processSplitGroups(int firstGroup, int startSample, int numSamples, const Parameters& step) noexcept
+{
+    auto current = parameters;
+    const auto inputMix = outputMix[0], lowPassMix = outputMix[2];
+
+    // When every group has the same sides one set of lane vectors serves them all, otherwise each group gets its own
+    constexpr int numSets = sharedSides ? 1 : groupsAtOnce;
+
+    Vector ic1[groupsAtOnce], ic2[groupsAtOnce];
+    Vector* samples[groupsAtOnce];
+
+    for (int group = 0; group < groupsAtOnce; ++group)
+    {
+        ic1[group] = state1[(size_t)(firstGroup + group)];
+        ic2[group] = state2[(size_t)(firstGroup + group)];
+        samples[group] = interleaved.data() + (firstGroup + group) * maximumSamples + startSample;
+    }
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        // Both sides' terms are worked out together, then spread across the lanes once for every group
+        SampleType a1[2], a2[2], a3[2], bandPassMix[2];
+
+        for (size_t side = 0; side < 2; ++side)
+        {
+            auto& g = current[side][0];
+            auto& k = current[side][1];
+
+            g += step[side][0];
+            k += step[side][1];
+
+            a1[side] = 1.f / (1.f + g * (g + k));
+            a2[side] = g * a1[side];
+            a3[side] = g * a2[side];
+            bandPassMix[side] = outputMix[1] * k;
+        }
+
+        // Scaling the lane masks by each side's value and adding puts it in that side's lanes, exactly
+        Vector a1Lanes[numSets], a2Lanes[numSets], a3Lanes[numSets], bandPassLanes[numSets];
+
+        for (int set = 0; set < numSets; ++set)
+        {
+            const auto& left = leftLanes[(size_t)(firstGroup + set)];
+            const auto& right = rightLanes[(size_t)(firstGroup + set)];
+
+            a1Lanes[set] = left * a1[0] + right * a1[1];
+            a2Lanes[set] = left * a2[0] + right * a2[1];
+            a3Lanes[set] = left * a3[0] + right * a3[1];
+            bandPassLanes[set] = left * bandPassMix[0] + right * bandPassMix[1];
+        }
+
+        for (int group = 0; group < groupsAtOnce; ++group)
+        {
+            const auto set = sharedSides ? 0 : group;
+            const auto input = samples[group][n];
+            const auto v3 = input - ic2[group];
+            const auto v1 = ic1[group] * a1Lanes[set] + v3 * a2Lanes[set];
+            const auto v2 = ic2[group] + ic1[group] * a2Lanes[set] + v3 * a3Lanes[set];
+
+            ic1[group] = v1 + v1 - ic1[group];
+            ic2[group] = v2 + v2 - ic2[group];
+
+            samples[group][n] = input * inputMix + v1 * bandPassLanes[set] + v2 * lowPassMix;
+        }
+    }
+
+    for (int group = 0; group < groupsAtOnce; ++group)
+    {
+        state1[(size_t)(firstGroup + group)] = ic1[group];
+        state2[(size_t)(firstGroup + group)] = ic2[group];
+    }
+}
+
+template <typename SampleType>
+void MultichannelSVF<SampleType>::process(int startSample, int numSamples, const SampleType* leftTargets, const SampleType* rightTargets) noexcept
+{
+    jassert(startSample + numSamples <= maximumSamples);
+
+    if (rightTargets == nullptr)
+        rightTargets = leftTargets;
+
+    // Any g > 0 and k > 0 is stable, so the ramp only smooths the sweep; it isn't needed for stability
+    Parameters step;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        step[0][i] = (leftTargets[i] - parameters[0][i]) / numSamples;
+        step[1][i] = (rightTargets[i] - parameters[1][i]) / numSamples;
+    }
+
+    // While both sides ramp alike, or no channel is on the right side, every lane shares the one per-sample division
+    const auto split = anyRightChannels && (parameters[0] != parameters[1] || step[0] != step[1]);
+    int group = 0;
+
+    for (; group + 2 <= numGroups; group += 2)
+    {
+        if (!split)
+            processGroups<2>(group, startSample, numSamples, step);
+        else if (samePattern)
+            processSplitGroups<2, true>(group, startSample, numSamples, step);
+        else
+            processSplitGroups<2, false>(group, startSample, numSamples, step);
+    }
+
+    if (group < numGroups)
+    {
+        if (split)
+            processSplitGroups<1, true>(group, startSample, numSamples, step);
+        else
+            processGroups<1>(group, startSample, numSamples, step);
+    }
+
+    // Land exactly on the target so rounding errors don't accumulate across ramps
+    setParameters(leftTargets, rightTargets);
+}
+
+//==============================================================================
+template class MultichannelSVF<float>;
+template class MultichannelSVF<double>;
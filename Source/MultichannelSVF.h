@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Outputs of the state variable filter, in the same order as the FilterType parameter
+enum StateVariableOutput
+{
+    bandPassOutput,
+    lowPassOutput,
+    highPassOutput,
+    notchOutput
+};
+
+//Topology-preserving (trapezoidal) state variable filter, after Andrew Simper's Cytomic design, running any number
+//of channels through one shared cutoff and resonance in juce::dsp::SIMDRegister lanes like MultichannelBiquad.
+//It's parameterised directly by g = tan(pi * cutoff / sampleRate) and k = 1 / Q, so a cutoff change costs one tan,
+//and it stays stable however fast those are modulated. The band-pass, low-pass, high-pass and notch outputs all come
+//from the same state, so switching between them never needs a reset. Instantiated for float and double in MultichannelSVF.cpp.
+//Like MultichannelBiquad's coefficients, the left and right channels may have their own (g, k).
+template <typename SampleType>
+class MultichannelSVF
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int lanes = (int)Vector::SIMDNumElements;
+
+    //==============================================================================
+    //Allocates state and interleaving storage, nothing is allocated after this
+    void prepare(int maximumChannels, int maximumBlockSize);
+    void reset();
+
+    //Jumps straight to a parameter set (g, k) for the left side's channels and one for the right side's, without ramping.
+    //Without a set for the right side every channel shares the first.
+    void setParameters(const SampleType* leftParameters, const SampleType* rightParameters = nullptr) noexcept;
+    void setOutput(int newOutput) noexcept;
+
+    //Marks the channels that take the right side's set, as MultichannelBiquad::setRightChannels() does
+    void setRightChannels(const juce::BigInteger& rightChannels) noexcept;
+
+    //==============================================================================
+    //Copies channels into the SIMD lanes, processes them and copies them back.
+    //Call process() between load() and store() for each stretch of the block that shares one ramp.
+    void load(const SampleType* const* channels, int numChannels, int numSamples) noexcept;
+    void process(int startSample, int numSamples, const SampleType* leftTargets, const SampleType* rightTargets = nullptr) noexcept;
+    void store(SampleType* const* channels, int numChannels, int numSamples) const noexcept;
+
+private:
+    //==============================================================================
+    using Parameters = std::array<std::array<SampleType, 2>, 2>;
+
+    int numGroups = 0, maximumSamples = 0;
+
+    //The left side's (g, k), then the right side's
+    Parameters parameters{ { { 0.1f, 1.f }, { 0.1f, 1.f } } };
+
+    //How much of the input, the band-pass state (scaled by k, so the band-pass peak is at unity like the biquad's)
+    //and the low-pass state make up the selected output
+    std::array<SampleType, 3> outputMix{ 0.f, 1.f, 0.f };
+
+    //One pair of integrator states per group of lanes, and the interleaved block stored group by group
+    std::vector<Vector> state1, state2, interleaved;
+
+    //Per group of lanes, 1 in the lanes of the left side's channels and 0 elsewhere, and the reverse for the right side
+    std::vector<Vector> leftLanes, rightLanes;
+    bool samePattern = true, anyRightChannels = false;
+
+    template <int groupsAtOnce>
+    void processGroups(int firstGroup, int startSample, int numSamples, const Parameters& step) noexcept;
+
+    //The same, with the left and right sides' parameters apart
+    template <int groupsAtOnce, bool sharedSides>
+    void processSplitGroups(int firstGroup, int startSample, int numSamples, const Parameters& step) noexcept;
+
+    SampleType* getLane(int sample, int channel) noexcept;
+    const SampleType* getLane(int sample, int channel) const noexcept;
+
+    JUCE_LEAK_DETECTOR(MultichannelSVF)
+};
@@ -3,80 +3,109 @@
 
 ResponseCurveComponent::ResponseCurveComponent(FunkyFilterAudioProcessor& p) : audioProcessor(p)
 {
+    audioProcessor.getTelemetry().setEnabled(true);
     startTimerHz(60);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
+    audioProcessor.getTelemetry().setEnabled(false);
 }
 
 void ResponseCurveComponent::timerCallback()
 {
-    //Update coefficients
-    auto filterSettings = getFilterSettings(audioProcessor.tree);
-    auto filterCoefficients = makeBandPassFilter(audioProcessor.getCurrentFilterFrequency(), filterSettings.filterQuality, audioProcessor.getSampleRate());
-    updateCoefficients(filter.coefficients, filterCoefficients);
-    repaint();
-}
+    //Drain the modulation records the audio thread queued since the last frame
+    auto numNewRecords = audioProcessor.getTelemetry().popAll([this](const ModulationRecord& record)
+        {
+            history[(size_t)historyPosition] = record;
+            historyPosition = (historyPosition + 1) % historyLength;
+            numHistoryRecords = juce::jmin(numHistoryRecords + 1, historyLength);
+        });
 
-void ResponseCurveComponent::paint(juce::Graphics& g)
-{
-    using namespace juce;
+    //Only redraw when something visible actually changed
+    auto filterSettings = getFilterSettings(audioProcessor.getParameterHandles());
+    auto cutoff = audioProcessor.getCurrentFilterFrequency();
+    auto sampleRate = audioProcessor.getFilterSampleRate();
 
-    g.fillAll(Colours::black);
+    // Each bank voice sweeps on its own, so all of their cutoffs are compared
+    auto bankChanged = filterSettings.bankVoices != drawnBankVoices;
 
-    // Get the bounds of the response area
-    auto filterResponseArea = getLocalBounds();
+    for (int voice = 1; voice < filterSettings.bankVoices; ++voice)
+    {
+        auto voiceFrequency = audioProcessor.getCurrentVoiceFrequency(voice);
+        bankChanged = bankChanged || voiceFrequency != drawnVoiceFrequencies[(size_t)voice];
+        drawnVoiceFrequencies[(size_t)voice] = voiceFrequency;
+    }
 
-    // Get the width of the response area
-    auto width = filterResponseArea.getWidth();
+    // The analyser sees the output at the host's rate, the response is drawn at the rate the filter runs at
+    spectrumAnalyser.setSampleRate(audioProcessor.getSampleRate());
+    auto spectrumChanged = spectrumAnalyser.acquirePath();
 
-    // Get the sample rate from the audio processor
-    auto sampleRate = audioProcessor.getSampleRate();
+    if (sampleRate != drawnSampleRate)
+    {
+        drawnSampleRate = sampleRate;
+        updatePhasors();
+    }
+    else if (numNewRecords == 0 && !spectrumChanged && !bankChanged
+             && cutoff == drawnCutoff
+             && filterSettings.filterQuality == drawnQuality
+             && filterSettings.minimumFrequency == drawnMinimumFrequency
+             && filterSettings.maximumFrequency == drawnMaximumFrequency
+             && filterSettings.useStateVariableFilter == drawnStateVariableFilter
+             && filterSettings.filterTypeIndex == drawnFilterType)
+    {
+        return;
+    }
 
-    // Prepare a vector to store magnitudes
-    std::vector<double> magnitudes;
-    magnitudes.resize(width);
+    drawnCutoff = cutoff;
+    drawnQuality = filterSettings.filterQuality;
+    drawnMinimumFrequency = filterSettings.minimumFrequency;
+    drawnMaximumFrequency = filterSettings.maximumFrequency;
+    drawnStateVariableFilter = filterSettings.useStateVariableFilter;
+    drawnFilterType = filterSettings.filterTypeIndex;
+    drawnBankVoices = filterSettings.bankVoices;
+    drawnVoiceFrequencies[0] = cutoff;
 
-    // Calculate the magnitude for each frequency
-    for (int i = 0; i < width; i++)
-    {
-        // Map pixel position to a frequency (logarithmic scale)
-        auto freq = mapToLog10(double(i) / double(width), 20.0, 20000.0);
+    updateResponseCurve();
+    repaint();
+}
 
-        // Get the filter's magnitude response for the frequency
-        double magnitude = filter.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+void ResponseCurveComponent::resized()
+{
+    spectrumAnalyser.setBounds(getWidth(), getHeight());
+    updateGridImage();
+    updatePhasors();
+    updateResponseCurve();
+}
 
-        // Convert the magnitude to decibels and store in the vector
-        magnitudes[i] = Decibels::gainToDecibels(magnitude);
+//Maps a gain in decibels to a vertical position (-12 dB at the bottom, 12 dB at the top)
+float ResponseCurveComponent::getPositionForDecibels(float decibels) const
+{
+    return juce::jmap(decibels, -12.f, 12.f, (float)getHeight(), 0.f);
+}
 
-    }
-    // Create a path for the response curve
-    Path responseCurve;
+//The frequency and dB grid never changes with the filter, so it's drawn once per size into an image
+void ResponseCurveComponent::updateGridImage()
+{
+    using namespace juce;
 
-    // Get the vertical bounds of the response area
-    const double outputMin = filterResponseArea.getBottom();
-    const double outputMax = filterResponseArea.getY();
+    auto width = getWidth();
+    auto height = getHeight();
 
-    // Lambda function to map decibel values to vertical position
-    auto map = [outputMin, outputMax](double input)
-        {
-            // Map amplitude to window height (-12 dB min, 12 dB max)
-            return jmap(input, -12.0, 12.0, outputMin, outputMax);
-        };
+    if (width <= 0 || height <= 0)
+        return;
 
-    // Start the path at the first magnitude point
-    responseCurve.startNewSubPath(filterResponseArea.getX(), map(magnitudes.front()));
+    // Render at the display's pixel density so the text stays sharp
+    auto scale = Component::getApproximateScaleFactorForComponent(this);
+    gridImage = Image(Image::RGB, roundToInt(width * scale), roundToInt(height * scale), true);
 
-    // Create the path for the response curve
-    for (size_t i = 1; i < magnitudes.size(); ++i)
-    {
-        responseCurve.lineTo(filterResponseArea.getX() + i, map(magnitudes[i]));
-    }
+    Graphics g(gridImage);
+    g.addTransform(AffineTransform::scale(scale));
+    g.fillAll(Colours::black);
 
     // Draw the border of the response area
     g.setColour(Colours::white);
-    g.drawRoundedRectangle(filterResponseArea.toFloat(), 5.f, 1.f);
+    g.drawRoundedRectangle(getLocalBounds().toFloat(), 5.f, 1.f);
 
     // Draw frequency scale
     g.setColour(Colours::yellow);
@@ -85,40 +114,176 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         auto xPos = pixelPositionForFrequency(i, width);
         g.setOpacity(0.3f);
         if (i < 15000) {
-            g.drawVerticalLine(xPos, 0, getHeight());
-            g.drawText(String(i) + " Hz", xPos - 25, getHeight() - 15, 50, 15, Justification::centred);
+            g.drawVerticalLine(xPos, 0, height);
+            g.drawText(String(i) + " Hz", xPos - 25, height - 15, 50, 15, Justification::centred);
         }
         else {
-            g.drawVerticalLine(xPos, 0, getHeight());
-            g.drawText("15.36 k", xPos - 25, getHeight() - 15, 50, 15, Justification::centred);
-        } 
+            g.drawVerticalLine(xPos, 0, height);
+            g.drawText("15.36 k", xPos - 25, height - 15, 50, 15, Justification::centred);
+        }
     }
 
     // Draw dB scale
     g.setColour(Colours::blue);
     for (int i = -9; i <= 9; i += 3)
     {
-        auto yPos = map(i);
+        auto yPos = getPositionForDecibels(i);
         g.setOpacity(0.3f);
-        g.drawHorizontalLine(yPos, 0, getWidth());   
+        g.drawHorizontalLine(roundToInt(yPos), 0, width);
         g.setOpacity(0.5f);
-        g.drawText(String(i) + " dB", getWidth() - 40, yPos - 7, 35, 15, Justification::centredRight);
+        g.drawText(String(i) + " dB", width - 40, roundToInt(yPos) - 7, 35, 15, Justification::centredRight);
+    }
+}
+
+//Precomputes z^-1 and z^-2 for every pixel's frequency, so evaluating the response is plain arithmetic
+void ResponseCurveComponent::updatePhasors()
+{
+    auto width = (size_t)juce::jmax(0, getWidth());
+    auto sampleRate = audioProcessor.getFilterSampleRate();
+
+    cosOmega.resize(width);
+    sinOmega.resize(width);
+    cosTwoOmega.resize(width);
+    sinTwoOmega.resize(width);
+    magnitudes.resize(width);
+    responseReal.resize(width);
+    responseImaginary.resize(width);
+
+    for (size_t i = 0; i < width; ++i)
+    {
+        // Map pixel position to a frequency (logarithmic scale), then to an angle on the unit circle
+        auto freq = juce::mapToLog10(double(i) / double(width), 20.0, 20000.0);
+        auto omega = sampleRate > 0 ? juce::MathConstants<double>::twoPi * juce::jmin(freq, sampleRate / 2) / sampleRate : 0.0;
+
+        cosOmega[i] = (float)std::cos(omega);
+        sinOmega[i] = (float)std::sin(omega);
+        cosTwoOmega[i] = (float)std::cos(2.0 * omega);
+        sinTwoOmega[i] = (float)std::sin(2.0 * omega);
     }
+}
+
+//Evaluates the filter's magnitude response at every pixel and rebuilds the curve
+void ResponseCurveComponent::updateResponseCurve()
+{
+    responseCurve.clear();
+
+    auto sampleRate = audioProcessor.getFilterSampleRate();
+    if (magnitudes.empty() || sampleRate <= 0)
+        return;
+
+    // The bank's voices run in parallel, so their complex responses are summed before taking the magnitude
+    std::fill(responseReal.begin(), responseReal.end(), 0.f);
+    std::fill(responseImaginary.begin(), responseImaginary.end(), 0.f);
+
+    const auto numVoices = juce::jmax(1, drawnBankVoices);
+
+    for (int voice = 0; voice < numVoices; ++voice)
+    {
+        // The SVF engine is drawn through its equivalent biquad, so one evaluation covers both engines
+        float c[5];
+
+        if (numVoices > 1)
+        {
+            // Same gain as the processor applies to the summed voices
+            const auto gain = 1.f / std::sqrt((float)numVoices);
+            makeBandPassFilter(c, drawnVoiceFrequencies[(size_t)voice], drawnQuality, sampleRate);
+            c[0] *= gain;
+            c[2] *= gain;
+        }
+        else if (drawnStateVariableFilter)
+            makeStateVariableResponse(c, drawnCutoff, drawnQuality, sampleRate, drawnFilterType);
+        else
+            makeBandPassFilter(c, drawnCutoff, drawnQuality, sampleRate);
+        const auto b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+
+        // H = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2), with z^-n = cos(n w) - j sin(n w)
+        for (size_t i = 0; i < magnitudes.size(); ++i)
+        {
+            const auto numeratorReal = b0 + b1 * cosOmega[i] + b2 * cosTwoOmega[i];
+            const auto numeratorImaginary = b1 * sinOmega[i] + b2 * sinTwoOmega[i];
+            const auto denominatorReal = 1.f + a1 * cosOmega[i] + a2 * cosTwoOmega[i];
+            const auto denominatorImaginary = a1 * sinOmega[i] + a2 * sinTwoOmega[i];
+            const auto denominatorSquared = denominatorReal * denominatorReal + denominatorImaginary * denominatorImaginary;
+
+            responseReal[i] += (numeratorReal * denominatorReal + numeratorImaginary * denominatorImaginary) / denominatorSquared;
+            responseImaginary[i] += (numeratorReal * denominatorImaginary - numeratorImaginary * denominatorReal) / denominatorSquared;
+        }
+    }
+
+    for (size_t i = 0; i < magnitudes.size(); ++i)
+        magnitudes[i] = responseReal[i] * responseReal[i] + responseImaginary[i] * responseImaginary[i];
+
+    // Convert the squared magnitudes to decibels and trace the path
+    for (size_t i = 0; i < magnitudes.size(); ++i)
+    {
+        auto decibels = 10.f * std::log10(juce::jmax(magnitudes[i], 1.0e-12f));
+
+        if (i == 0)
+            responseCurve.startNewSubPath(0.f, getPositionForDecibels(decibels));
+        else
+            responseCurve.lineTo((float)i, getPositionForDecibels(decibels));
+    }
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    auto width = getWidth();
+
+    // Draw the cached grid
+    g.drawImage(gridImage, getLocalBounds().toFloat());
+
+    // Draw the output spectrum behind the response curve
+    g.setColour(Colours::lightgrey.withAlpha(0.25f));
+    g.fillPath(spectrumAnalyser.getPath());
 
     // Draw the amplitude response curve
     g.setColour(Colours::green);
     g.strokePath(responseCurve, PathStrokeType(2.f));
 
-    // Get the filter settings from the audio processor
-    auto filterSettings = getFilterSettings(audioProcessor.tree);
-
     // Draw vertical lines at the minimum and maximum frequencies
     g.setColour(juce::Colours::red);
-    int xMinPos = pixelPositionForFrequency(filterSettings.minimumFrequency, width);
-    int xMaxPos = pixelPositionForFrequency(filterSettings.maximumFrequency, width);
+    int xMinPos = pixelPositionForFrequency(drawnMinimumFrequency, width);
+    int xMaxPos = pixelPositionForFrequency(drawnMaximumFrequency, width);
     g.drawLine(xMinPos, 0, xMinPos, getHeight(), 2.0f);
     g.drawLine(xMaxPos, 0, xMaxPos, getHeight(), 2.0f);
 
+    drawTelemetry(g, width);
+}
+
+//Draws the recent sweep trajectory (cutoff against LFO phase) and the output level history
+void ResponseCurveComponent::drawTelemetry(juce::Graphics& g, int width)
+{
+    using namespace juce;
+
+    if (numHistoryRecords == 0)
+        return;
+
+    const auto height = (float)getHeight();
+    const auto levelArea = getLocalBounds().removeFromBottom(30).toFloat();
+    const auto barWidth = (float)width / historyLength;
+
+    for (int i = 0; i < numHistoryRecords; ++i)
+    {
+        // Oldest first, so newer records are drawn on top and brighter
+        const auto& record = history[(size_t)((historyPosition - numHistoryRecords + i + historyLength) % historyLength)];
+        const auto age = (float)(i + 1) / numHistoryRecords;
+
+        // Trajectory: where the cutoff was at each point of the LFO cycle
+        g.setColour(Colours::orange.withAlpha(age));
+        g.fillEllipse((float)pixelPositionForFrequency(record.cutoff, width) - 1.5f, record.phase * height - 1.5f, 3.f, 3.f);
+
+        // Level history: RMS as a bar and peak as a tick, from -60 dB to 0 dB
+        const auto x = levelArea.getX() + (i + historyLength - numHistoryRecords) * barWidth;
+        const auto rmsHeight = jmap(jlimit(-60.f, 0.f, Decibels::gainToDecibels(record.rms)), -60.f, 0.f, 0.f, levelArea.getHeight());
+        const auto peakHeight = jmap(jlimit(-60.f, 0.f, Decibels::gainToDecibels(record.peak)), -60.f, 0.f, 0.f, levelArea.getHeight());
+
+        g.setColour(Colours::cyan.withAlpha(0.4f));
+        g.fillRect(x, levelArea.getBottom() - rmsHeight, barWidth, rmsHeight);
+        g.setColour(Colours::cyan);
+        g.fillRect(x, levelArea.getBottom() - peakHeight, barWidth, 1.f);
+    }
 }
 
 int ResponseCurveComponent::pixelPositionForFrequency(double frequency, int width)
@@ -138,27 +303,120 @@ int ResponseCurveComponent::pixelPositionForFrequency(double frequency, int widt
     return static_cast<int>(normValue * width);
 }
 
+//==============================================================================
+LoadMeterComponent::LoadMeterComponent(ProcessLoadMonitor& monitor) : loadMonitor(monitor)
+{
+    // Only the trace button takes clicks, the readout leaves them to the response curve underneath
+    setInterceptsMouseClicks(false, true);
+
+    traceButton.setButtonText("Trace");
+    traceButton.setToggleState(loadMonitor.isTracing(), juce::dontSendNotification);
+    traceButton.onClick = [this]() {
+        if (!traceButton.getToggleState())
+        {
+            loadMonitor.stopTrace();
+            return;
+        }
+
+        // One CSV per trace in the user's documents, named by when it started
+        auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                        .getChildFile("FunkyFilter")
+                        .getChildFile("trace_" + juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S") + ".csv");
+        file.getParentDirectory().createDirectory();
+
+        if (!loadMonitor.startTrace(file))
+            traceButton.setToggleState(false, juce::dontSendNotification);
+        };
+    addAndMakeVisible(traceButton);
+
+    startTimerHz(4);
+}
+
+LoadMeterComponent::~LoadMeterComponent()
+{
+}
+
+void LoadMeterComponent::timerCallback()
+{
+    statistics = loadMonitor.getStatistics();
+    repaint();
+}
+
+//Load and p99/worst block as a percentage of the budget, and how many blocks came within 70% of it or went over
+void LoadMeterComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    g.setColour(Colours::black.withAlpha(0.6f));
+    g.fillRect(getLocalBounds());
+
+    // Amber once any block has come close to the budget, red once one has gone over
+    const auto colour = statistics.overruns > 0 ? Colours::red : statistics.nearOverruns > 0 ? Colours::orange : Colours::white;
+    const auto toPercent = [](double load) { return String(load * 100.0, 1) + "%"; };
+
+    g.setColour(colour);
+    g.setFont(12.f);
+    g.drawText("CPU " + toPercent(statistics.load) + "  p99 " + toPercent(statistics.p99BlockLoad),
+               4, 2, getWidth() - 8, 14, Justification::left);
+    g.drawText("Worst " + toPercent(statistics.worstBlockLoad) + " (" + String(statistics.worstBlockSeconds * 1000.0, 2) + " ms)",
+               4, 16, getWidth() - 8, 14, Justification::left);
+    g.drawText("Near xruns " + String(statistics.nearOverruns) + "  xruns " + String(statistics.overruns),
+               4, 30, getWidth() - 8, 14, Justification::left);
+}
+
+void LoadMeterComponent::resized()
+{
+    traceButton.setBounds(getWidth() - 64, getHeight() - 20, 64, 20);
+}
+
 //==============================================================================
 FunkyFilterAudioProcessorEditor::FunkyFilterAudioProcessorEditor(FunkyFilterAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p), // Initialize base class and reference to audio processor
     responseCurveComponent(audioProcessor), // Initialize response curve component with the audio processor
+    loadMeterComponent(audioProcessor.getLoadMonitor()),
     filterFrequencySliderAttachment(audioProcessor.tree, "FilterFrequency", filterFrequencySlider),
     filterQSliderAttachment(audioProcessor.tree, "FilterQuality", filterQSlider),
     maximumFrequencySliderAttachment(audioProcessor.tree, "MaximumFrequency", maximumFrequencySlider),
     minimumFrequencySliderAttachment(audioProcessor.tree, "MinimumFrequency", minimumFrequencySlider),
     bpmSliderAttachment(audioProcessor.tree, "BPM", bpmSlider),
     useNoteDurationButtonAttachment(audioProcessor.tree, "UseNoteDuration", useNoteDurationButton),
-    noteDurationComboBoxAttachment(audioProcessor.tree, "NoteDuration", noteDurationComboBox)
+    transportSyncButtonAttachment(audioProcessor.tree, "TransportSync", transportSyncButton),
+    coefficientTableButtonAttachment(audioProcessor.tree, "CoefficientTable", coefficientTableButton),
+    fastMathButtonAttachment(audioProcessor.tree, "FastMath", fastMathButton),
+    bankSpreadSliderAttachment(audioProcessor.tree, "BankSpread", bankSpreadSlider),
+    bankPhaseOffsetSliderAttachment(audioProcessor.tree, "BankPhaseOffset", bankPhaseOffsetSlider),
+    envelopeAttackSliderAttachment(audioProcessor.tree, "EnvelopeAttack", envelopeAttackSlider),
+    envelopeReleaseSliderAttachment(audioProcessor.tree, "EnvelopeRelease", envelopeReleaseSlider),
+    stereoSpreadSliderAttachment(audioProcessor.tree, "StereoSpread", stereoSpreadSlider)
 {
     // Add components to the editor
     addAndMakeVisible(responseCurveComponent);
+    addAndMakeVisible(loadMeterComponent);
     addAndMakeVisible(filterFrequencySlider);
     addAndMakeVisible(filterQSlider);
     addAndMakeVisible(minimumFrequencySlider);
     addAndMakeVisible(maximumFrequencySlider);
     addAndMakeVisible(useNoteDurationButton);
+    addAndMakeVisible(transportSyncButton);
+    addAndMakeVisible(coefficientTableButton);
+    addAndMakeVisible(fastMathButton);
     addAndMakeVisible(bpmSlider);
     addAndMakeVisible(noteDurationComboBox);
+    addAndMakeVisible(controlRateComboBox);
+    addAndMakeVisible(filterEngineComboBox);
+    addAndMakeVisible(filterTypeComboBox);
+    addAndMakeVisible(lfoShapeComboBox);
+    addAndMakeVisible(bankVoicesComboBox);
+    addAndMakeVisible(bankSpreadSlider);
+    addAndMakeVisible(bankPhaseOffsetSlider);
+    addAndMakeVisible(oversamplingComboBox);
+    addAndMakeVisible(offlineOversamplingComboBox);
+    addAndMakeVisible(oversamplingFilterComboBox);
+    addAndMakeVisible(envelopeMixSlider);
+    addAndMakeVisible(envelopeAttackSlider);
+    addAndMakeVisible(envelopeReleaseSlider);
+    addAndMakeVisible(envelopeDetectorComboBox);
+    addAndMakeVisible(stereoSpreadSlider);
 
     // Set up and add labels
     filterFrequencyLabel.setText("Mod Frequency", juce::dontSendNotification);
@@ -185,12 +443,86 @@ FunkyFilterAudioProcessorEditor::FunkyFilterAudioProcessorEditor(FunkyFilterAudi
     noteDurationLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(noteDurationLabel);
 
+    controlRateLabel.setText("Control Rate", juce::dontSendNotification);
+    controlRateLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(controlRateLabel);
+
     // Set up button text
     useNoteDurationButton.setButtonText("Use Note Duration (Click me)");
+    coefficientTableButton.setButtonText("Coefficient Cache");
+    fastMathButton.setButtonText("Fast Math");
+    transportSyncButton.setButtonText("Host Sync");
     
     // Populate note duration combo box
     noteDurationComboBox.addItemList({ "1 Note", "1/2 Note", "1/4 Note", "1/8 Note", "1/16 Note" }, 1);
 
+    // Populate control rate combo box
+    controlRateComboBox.addItemList({ "Every Sample", "16 Samples", "32 Samples", "64 Samples" }, 1);
+
+    noteDurationComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "NoteDuration", noteDurationComboBox);
+    controlRateComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "ControlRate", controlRateComboBox);
+
+    // Populate filter engine and type combo boxes; the type only applies to the state variable engine
+    filterEngineComboBox.addItemList({ "Biquad", "State Variable" }, 1);
+    filterTypeComboBox.addItemList({ "Band Pass", "Low Pass", "High Pass", "Notch" }, 1);
+
+    // Populate the oversampling combo boxes, one factor for playing live and one for bouncing
+    oversamplingComboBox.addItemList({ "Live 1x", "Live 2x", "Live 4x", "Live 8x" }, 1);
+    offlineOversamplingComboBox.addItemList({ "Bounce 1x", "Bounce 2x", "Bounce 4x", "Bounce 8x" }, 1);
+    oversamplingFilterComboBox.addItemList({ "Polyphase IIR", "Linear Phase FIR" }, 1);
+
+    oversamplingComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "Oversampling", oversamplingComboBox);
+    offlineOversamplingComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "OfflineOversampling", offlineOversamplingComboBox);
+    oversamplingFilterComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "OversamplingFilter", oversamplingFilterComboBox);
+
+    // Populate the bank voices combo box; the bank replaces the single band (and its engine) while it's on
+    bankVoicesComboBox.addItemList({ "Bank Off", "2 Voices", "3 Voices", "4 Voices", "5 Voices", "6 Voices", "7 Voices", "8 Voices" }, 1);
+
+    bankSpreadSlider.setTextValueSuffix(" oct");
+    bankPhaseOffsetSlider.setTextValueSuffix(" cyc");
+    stereoSpreadSlider.setTextValueSuffix(" deg st");
+
+    // The attachments select their item synchronously, whether the change came from here, host automation or a restored
+    // state, so the controls are enabled to match from onChange rather than only on clicks
+    filterEngineComboBox.onChange = [this]() {
+        const auto bankOn = bankVoicesComboBox.getSelectedItemIndex() > 0;
+        filterEngineComboBox.setEnabled(!bankOn);
+        filterTypeComboBox.setEnabled(!bankOn && filterEngineComboBox.getSelectedItemIndex() == 1);
+        bankSpreadSlider.setEnabled(bankOn);
+        bankPhaseOffsetSlider.setEnabled(bankOn);
+        stereoSpreadSlider.setEnabled(!bankOn); // The bank is the same on every channel
+        };
+    bankVoicesComboBox.onChange = filterEngineComboBox.onChange;
+
+    filterEngineComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "FilterEngine", filterEngineComboBox);
+    filterTypeComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "FilterType", filterTypeComboBox);
+    bankVoicesComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "BankVoices", bankVoicesComboBox);
+    filterEngineComboBox.onChange();
+
+    // Populate LFO shape combo box
+    lfoShapeComboBox.addItemList({ "Sine", "Triangle", "Saw", "Square", "Sample & Hold" }, 1);
+    lfoShapeComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "LfoShape", lfoShapeComboBox);
+
+    // The envelope follower listens to the sidechain (or the input without one) and is blended with the LFO by its mix
+    envelopeDetectorComboBox.addItemList({ "Peak", "RMS" }, 1);
+    envelopeMixSlider.setTextValueSuffix(" env");
+    envelopeAttackSlider.setTextValueSuffix(" ms att");
+    envelopeReleaseSlider.setTextValueSuffix(" ms rel");
+
+    envelopeDetectorComboBoxAttachment = std::make_unique<comboBoxAttachment>(audioProcessor.tree, "EnvelopeDetector", envelopeDetectorComboBox);
+
+    // Like the engine controls, the envelope controls are enabled from the attachment's synchronous notification, so
+    // they also follow host automation and restored states of EnvelopeMix
+    envelopeMixSlider.onValueChange = [this]() {
+        const auto envelopeOn = envelopeMixSlider.getValue() > 0;
+        envelopeAttackSlider.setEnabled(envelopeOn);
+        envelopeReleaseSlider.setEnabled(envelopeOn);
+        envelopeDetectorComboBox.setEnabled(envelopeOn);
+        };
+
+    envelopeMixSliderAttachment = std::make_unique<sliderAttachment>(audioProcessor.tree, "EnvelopeMix", envelopeMixSlider);
+    envelopeMixSlider.onValueChange();
+
     // Set bounds for labels
     filterFrequencyLabel.setBounds(75, 290, 150, 20); 
     bpmLabel.setBounds(75, 290, 150, 20);
@@ -227,7 +559,12 @@ FunkyFilterAudioProcessorEditor::FunkyFilterAudioProcessorEditor(FunkyFilterAudi
         bpmSlider.setVisible(useNoteDuration);
         bpmLabel.setVisible(useNoteDuration);
         noteDurationComboBox.setVisible(useNoteDuration);
+        transportSyncButton.setVisible(useNoteDuration);
+
+        // Synced to the host, the LFO follows the host's tempo rather than the BPM slider
+        bpmSlider.setEnabled(!transportSyncButton.getToggleState());
         };
+    transportSyncButton.onClick = useNoteDurationButton.onClick;
     useNoteDurationButton.onClick();
 
     // Set the size of the window
@@ -251,6 +588,7 @@ void FunkyFilterAudioProcessorEditor::resized()
     auto filterResponseArea = bounds.removeFromTop(0.5 * bounds.getHeight());
 
     responseCurveComponent.setBounds(filterResponseArea);
+    loadMeterComponent.setBounds(filterResponseArea.getX() + 5, filterResponseArea.getY() + 5, 190, 66);
 
     auto filterParametersArea = bounds.removeFromTop(0.5 * bounds.getHeight());
     auto filterFrequencySliderArea = filterParametersArea.removeFromLeft(0.5 * filterParametersArea.getWidth());
@@ -264,4 +602,23 @@ void FunkyFilterAudioProcessorEditor::resized()
 
     useNoteDurationButton.setBounds(filterFrequencySliderArea.getRight() - 80, filterFrequencySliderArea.getY() + 10, 150, 50);
     noteDurationComboBox.setBounds(filterFrequencySliderArea.getRight() - 80, filterFrequencySliderArea.getY() + 80, 150, 20);
+    transportSyncButton.setBounds(filterFrequencySliderArea.getX() + 5, filterFrequencySliderArea.getY() + 10, 95, 20);
+    lfoShapeComboBox.setBounds(filterFrequencySliderArea.getRight() - 80, filterFrequencySliderArea.getY() + 57, 150, 20);
+    controlRateLabel.setBounds(filterParametersArea.getRight() - 100, filterParametersArea.getY() + 10, 95, 20);
+    controlRateComboBox.setBounds(filterParametersArea.getRight() - 100, filterParametersArea.getY() + 30, 95, 20);
+    coefficientTableButton.setBounds(filterParametersArea.getRight() - 100, filterParametersArea.getY() + 55, 100, 20);
+    fastMathButton.setBounds(filterParametersArea.getRight() - 100, filterParametersArea.getY() + 80, 100, 20);
+    envelopeMixSlider.setBounds(filterParametersArea.getX() + 5, filterParametersArea.getY() + 8, 95, 20);
+    envelopeAttackSlider.setBounds(filterParametersArea.getX() + 5, filterParametersArea.getY() + 30, 95, 20);
+    envelopeReleaseSlider.setBounds(filterParametersArea.getX() + 5, filterParametersArea.getY() + 52, 95, 20);
+    envelopeDetectorComboBox.setBounds(filterParametersArea.getX() + 5, filterParametersArea.getY() + 74, 95, 20);
+    filterEngineComboBox.setBounds(bounds.getRight() - 100, bounds.getY() + 10, 95, 20);
+    filterTypeComboBox.setBounds(bounds.getRight() - 100, bounds.getY() + 35, 95, 20);
+    bankVoicesComboBox.setBounds(minimumFrequencyArea.getX() + 5, minimumFrequencyArea.getY() + 10, 95, 20);
+    bankSpreadSlider.setBounds(minimumFrequencyArea.getX() + 5, minimumFrequencyArea.getY() + 35, 95, 20);
+    bankPhaseOffsetSlider.setBounds(minimumFrequencyArea.getX() + 5, minimumFrequencyArea.getY() + 60, 95, 20);
+    stereoSpreadSlider.setBounds(minimumFrequencyArea.getX() + 5, minimumFrequencyArea.getY() + 85, 95, 20);
+    oversamplingComboBox.setBounds(bounds.getX() + 5, bounds.getY() + 10, 95, 20);
+    offlineOversamplingComboBox.setBounds(bounds.getX() + 5, bounds.getY() + 35, 95, 20);
+    oversamplingFilterComboBox.setBounds(bounds.getX() + 5, bounds.getY() + 60, 95, 20);
 }
@@ -11,6 +11,15 @@ struct MyRotarySlider : juce::Slider
     }
 };
 
+//Compact bar that shows its value inside, for secondary settings
+struct MyBarSlider : juce::Slider
+{
+    MyBarSlider() : juce::Slider(juce::Slider::SliderStyle::LinearBar,
+        juce::Slider::TextEntryBoxPosition::TextBoxLeft)
+    {
+    }
+};
+
 struct ResponseCurveComponent : juce::Component, juce::Timer
 {
 public:
@@ -21,11 +30,57 @@ public:
     //==============================================================================
     void timerCallback() override;
     void paint(juce::Graphics& g) override;
+    void resized() override;
     int pixelPositionForFrequency(double frequency, int width);
 
 private:
     FunkyFilterAudioProcessor& audioProcessor;
-    juce::dsp::IIR::Filter<float> filter;
+
+    // Live spectrum of the processed output, analysed on its own thread while the editor is open
+    SpectrumAnalyser spectrumAnalyser{ audioProcessor.getSpectrumFifo() };
+
+    // What the curve was last drawn for, so the timer only repaints on changes
+    double drawnCutoff = 1000.0, drawnSampleRate = 0;
+    float drawnQuality = 1.f, drawnMinimumFrequency = 20.f, drawnMaximumFrequency = 20000.f;
+    bool drawnStateVariableFilter = false;
+    int drawnFilterType = 0, drawnBankVoices = 1;
+    std::array<double, BiquadBank<float>::maximumVoices> drawnVoiceFrequencies{};
+
+    // Cached grid, per-pixel phasors (z^-1 and z^-2) and the response curve built from them
+    juce::Image gridImage;
+    std::vector<float> cosOmega, sinOmega, cosTwoOmega, sinTwoOmega, magnitudes, responseReal, responseImaginary;
+    juce::Path responseCurve;
+
+    float getPositionForDecibels(float decibels) const;
+    void updateGridImage();
+    void updatePhasors();
+    void updateResponseCurve();
+
+    // Most recent modulation records drained from the processor, kept in a circular history
+    static constexpr int historyLength = 512;
+    std::array<ModulationRecord, historyLength> history{};
+    int historyPosition = 0, numHistoryRecords = 0;
+
+    void drawTelemetry(juce::Graphics& g, int width);
+};
+
+//Processing load readout, overlaid on the response curve, with a toggle to trace every block's timing to a file
+struct LoadMeterComponent : juce::Component, juce::Timer
+{
+public:
+    //==============================================================================
+    LoadMeterComponent(ProcessLoadMonitor&);
+    ~LoadMeterComponent();
+
+    //==============================================================================
+    void timerCallback() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    ProcessLoadMonitor& loadMonitor;
+    ProcessLoadStatistics statistics;
+    juce::ToggleButton traceButton;
 };
 
 //==============================================================================
@@ -43,10 +98,13 @@ private:
     FunkyFilterAudioProcessor& audioProcessor;
 
     MyRotarySlider filterFrequencySlider, filterQSlider, maximumFrequencySlider, minimumFrequencySlider, bpmSlider;
-    juce::ToggleButton useNoteDurationButton;
-    juce::ComboBox noteDurationComboBox;
-    juce::Label filterFrequencyLabel, filterQLabel, minimumFrequencyLabel, maximumFrequencyLabel, bpmLabel, noteDurationLabel;
+    juce::ToggleButton useNoteDurationButton, transportSyncButton, coefficientTableButton, fastMathButton;
+    MyBarSlider bankSpreadSlider, bankPhaseOffsetSlider, envelopeMixSlider, envelopeAttackSlider, envelopeReleaseSlider, stereoSpreadSlider;
+    juce::ComboBox noteDurationComboBox, controlRateComboBox, filterEngineComboBox, filterTypeComboBox, lfoShapeComboBox, bankVoicesComboBox;
+    juce::ComboBox oversamplingComboBox, offlineOversamplingComboBox, oversamplingFilterComboBox, envelopeDetectorComboBox;
+    juce::Label filterFrequencyLabel, filterQLabel, minimumFrequencyLabel, maximumFrequencyLabel, bpmLabel, noteDurationLabel, controlRateLabel;
     ResponseCurveComponent responseCurveComponent;
+    LoadMeterComponent loadMeterComponent;
     
     using apvts = juce::AudioProcessorValueTreeState;
     using sliderAttachment = apvts::SliderAttachment;
@@ -54,8 +112,21 @@ private:
     using comboBoxAttachment = apvts::ComboBoxAttachment;
 
     sliderAttachment filterFrequencySliderAttachment, filterQSliderAttachment, maximumFrequencySliderAttachment, minimumFrequencySliderAttachment, bpmSliderAttachment;
-    buttonAttachment useNoteDurationButtonAttachment;
-    comboBoxAttachment noteDurationComboBoxAttachment;
+    buttonAttachment useNoteDurationButtonAttachment, transportSyncButtonAttachment, coefficientTableButtonAttachment, fastMathButtonAttachment;
+    sliderAttachment bankSpreadSliderAttachment, bankPhaseOffsetSliderAttachment;
+    sliderAttachment envelopeAttackSliderAttachment, envelopeReleaseSliderAttachment;
+    sliderAttachment stereoSpreadSliderAttachment;
+
+    // A combo box attachment selects the parameter's item as soon as it's made, so these are only made once the
+    // items are in; an attachment made before would leave its combo box blank until the parameter next changed
+    std::unique_ptr<comboBoxAttachment> noteDurationComboBoxAttachment, controlRateComboBoxAttachment;
+    std::unique_ptr<comboBoxAttachment> filterEngineComboBoxAttachment, filterTypeComboBoxAttachment, lfoShapeComboBoxAttachment;
+    std::unique_ptr<comboBoxAttachment> bankVoicesComboBoxAttachment;
+    std::unique_ptr<comboBoxAttachment> oversamplingComboBoxAttachment, offlineOversamplingComboBoxAttachment, oversamplingFilterComboBoxAttachment;
+    std::unique_ptr<comboBoxAttachment> envelopeDetectorComboBoxAttachment;
+
+    // Made after its onValueChange, which then follows EnvelopeMix however it changes
+    std::unique_ptr<sliderAttachment> envelopeMixSliderAttachment;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FunkyFilterAudioProcessorEditor)
 };
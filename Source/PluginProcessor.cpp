@@ -1,5 +1,8 @@
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+
+#if ! FUNKYFILTER_HEADLESS
+ #include "PluginEditor.h"
+#endif
 
 //==============================================================================
 FunkyFilterAudioProcessor::FunkyFilterAudioProcessor()
@@ -8,16 +11,40 @@ FunkyFilterAudioProcessor::FunkyFilterAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    sharedCoefficientTables->getThread().addTimeSliceClient(&coefficientTableCache);
+
+    // Listen to every parameter so derived state is only recomputed when something actually changed
+    for (auto* parameter : getParameters())
+        if (auto* parameterWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+            tree.addParameterListener(parameterWithID->paramID, this);
+
+    // Every parameter has its place in the binary state, or it wouldn't be saved
+    for (int i = 0; i < PresetState::numParameters; ++i)
+        stateParameters[(size_t)i] = tree.getParameter(PresetState::parameterIDs[i]);
+
+    jassert(getParameters().size() == PresetState::numParameters
+            && std::find(stateParameters.begin(), stateParameters.end(), nullptr) == stateParameters.end());
+
+    startTimerHz(10);
 }
 
 FunkyFilterAudioProcessor::~FunkyFilterAudioProcessor()
 {
+    stopTimer();
+
+    for (auto* parameter : getParameters())
+        if (auto* parameterWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+            tree.removeParameterListener(parameterWithID->paramID, this);
+
+    // Waits for the shared thread if it's in the middle of serving this instance
+    sharedCoefficientTables->getThread().removeTimeSliceClient(&coefficientTableCache);
 }
 
 //==============================================================================
@@ -53,29 +80,41 @@ bool FunkyFilterAudioProcessor::isMidiEffect() const
    #endif
 }
 
+//How long the filter keeps ringing after the input stops, for the lowest cutoff it can sweep to at the current Q
 double FunkyFilterAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    const auto filterSettings = getFilterSettings(parameterHandles);
+    const auto sampleRate = getSampleRate() > 0 ? getSampleRate() : 44100.0;
+    const auto lowestFrequency = juce::jmin(filterSettings.minimumFrequency, filterSettings.maximumFrequency);
+
+    return getFilterDecaySamples(lowestFrequency, filterSettings.filterQuality, sampleRate, tailDecibels) / sampleRate;
 }
 
+//Programs are the shared preset bank's presets, the factory ones first (so there is always at least one), as they
+//were when this instance was created
 int FunkyFilterAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return juce::jmax(1, (int)programs->size());
 }
 
 int FunkyFilterAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
+//The bank has parsed every preset already, so recalling one only writes its values
 void FunkyFilterAudioProcessor::setCurrentProgram (int index)
 {
+    if (!juce::isPositiveAndBelow(index, (int)programs->size()))
+        return;
+
+    applyState((*programs)[(size_t)index].values);
+    currentProgram.store(index);
 }
 
 const juce::String FunkyFilterAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return juce::isPositiveAndBelow(index, (int)programs->size()) ? (*programs)[(size_t)index].name : juce::String();
 }
 
 void FunkyFilterAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -85,29 +124,65 @@ void FunkyFilterAudioProcessor::changeProgramName (int index, const juce::String
 //==============================================================================
 void FunkyFilterAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Initialize the wavetable used for modulation
-    initiateWavetable();
+    // Prepare the filters for every output channel of the current layout, at the precision the host will process in;
+    // the storage scales with the channel count so nothing has to be allocated while processing
+    const auto numChannels = getTotalNumOutputChannels();
+    const auto useDoublePrecision = isUsingDoublePrecision();
+
+    // The engines may run at up to the highest oversampling factor, so they have room for that many samples
+    const auto maximumFilterBlockSize = samplesPerBlock * maximumOversamplingFactor;
+
+    floatEngines.biquad.prepare(useDoublePrecision ? 0 : numChannels, maximumFilterBlockSize);
+    floatEngines.stateVariable.prepare(useDoublePrecision ? 0 : numChannels, maximumFilterBlockSize);
+    doubleEngines.biquad.prepare(useDoublePrecision ? numChannels : 0, maximumFilterBlockSize);
+    doubleEngines.stateVariable.prepare(useDoublePrecision ? numChannels : 0, maximumFilterBlockSize);
+    floatEngines.bank.prepare(useDoublePrecision ? 0 : numChannels);
+    doubleEngines.bank.prepare(useDoublePrecision ? numChannels : 0);
 
-    // Create a ProcessSpec object to specify processing requirements
-    juce::dsp::ProcessSpec spec;
+    // Only the right channels of the layout's left/right pairs take StereoSpread's set, whatever their index
+    const auto rightChannels = getRightChannels(getChannelLayoutOfBus(false, 0));
+    floatEngines.biquad.setRightChannels(rightChannels);
+    floatEngines.stateVariable.setRightChannels(rightChannels);
+    doubleEngines.biquad.setRightChannels(rightChannels);
+    doubleEngines.stateVariable.setRightChannels(rightChannels);
+    hasStereoPairs = !rightChannels.isZero();
 
-    // Set the maximum block size, number of channels, and sample rate for processing (each channel is processed seperately)
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    // Every oversampling stage is built now, so choosing another one while playing never allocates
+    prepareOversampling<float>(useDoublePrecision ? 0 : numChannels, samplesPerBlock);
+    prepareOversampling<double>(useDoublePrecision ? numChannels : 0, samplesPerBlock);
+    updateLatency();
 
-    // Prepare the left and right filters with the specified processing requirements
-    filterLeft.prepare(spec);
-    filterRight.prepare(spec);
+    // The envelope follower detects at the host's rate, before oversampling
+    floatEngines.envelope.prepare(sampleRate, useDoublePrecision ? 0 : samplesPerBlock);
+    doubleEngines.envelope.prepare(sampleRate, useDoublePrecision ? samplesPerBlock : 0);
 
-    // Retrieve parameters from the parameter tree
-    auto filterSettings = getFilterSettings(tree);
+    // Start from silence; the coefficients jump to the LFO position when sound arrives
+    flushFilter();
+    silentSamples = 0;
 
-    // Update the filter with the current settings, sample rate, and block size
-    updateFilter(filterSettings, sampleRate, samplesPerBlock);
+    // Load statistics are relative to the new block size and sample rate, so start them over
+    loadMonitor.prepare(sampleRate, samplesPerBlock);
+
+    // Room for every telemetry step a block can produce
+    pendingSteps.resize((size_t)(samplesPerBlock / minimumTelemetryStep + 2));
 
     // Reset the phase for modulation
     phase = 0.f;
+
+    // Until the shared thread has a table for the current settings, the filter falls back to computing coefficients directly
+    coefficientTable = nullptr;
+
+    // Retrieve parameters through the cached handles; the sample rate may have changed, so everything is recomputed
+    changedParameters.store(0);
+    currentSettings = getFilterSettings(parameterHandles);
+
+    // Selecting the oversampling stage sets the rate the filter runs at, and updates the modulation for it
+    activeOversamplingStage = -1;
+
+    if (useDoublePrecision)
+        selectOversampling<double>(getOversamplingStage());
+    else
+        selectOversampling<float>(getOversamplingStage());
 }
 
 void FunkyFilterAudioProcessor::releaseResources()
@@ -122,18 +197,23 @@ bool FunkyFilterAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout is supported (mono, stereo, surround, immersive or ambisonic) as long as it isn't disabled
+    // and fits the channel count the filter is built for; see getRightChannels for how StereoSpread applies to it.
+    // The default layout stays stereo, since some plugin hosts, such as certain
+    // GarageBand versions, will only load plugins that support stereo bus layouts.
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numChannels == 0 || numChannels > maximumNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain only feeds the envelope follower, which sums whatever channels it has
+    if (layouts.inputBuses.size() > 1 && layouts.getChannelSet(true, 1).size() > maximumNumChannels)
+        return false;
    #endif
 
     return true;
@@ -141,46 +221,193 @@ bool FunkyFilterAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
 }
 #endif
 
-void FunkyFilterAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+//Each precision keeps its own filter state and targets, prepared only when the host processes at that precision
+template <>
+FunkyFilterAudioProcessor::FilterEngines<float>& FunkyFilterAudioProcessor::getEngines<float>() noexcept
+{
+    return floatEngines;
+}
+
+template <>
+FunkyFilterAudioProcessor::FilterEngines<double>& FunkyFilterAudioProcessor::getEngines<double>() noexcept
+{
+    return doubleEngines;
+}
+
+void FunkyFilterAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+void FunkyFilterAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+//Hosts with a 64-bit mix engine can hand over their buffers directly, and low cutoffs at high Q keep their precision
+bool FunkyFilterAudioProcessor::supportsDoublePrecisionProcessing() const
 {
+    return true;
+}
+
+//Offline rendering has its own oversampling choice, so switching in or out of it can change the latency
+void FunkyFilterAudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+    updateLatency();
+}
+
+//The float and double processBlock share this; only the filter engines and their coefficients run at the sample type
+template <typename SampleType>
+void FunkyFilterAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
+{
+    // Everything below counts towards the block's time
+    const ProcessLoadMonitor::ScopedTimer loadTimer{ loadMonitor, buffer.getNumSamples() };
+
     //JUCE generated
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
+    // The sidechain's channels follow the main input's in the buffer, so only the main bus counts here
+    auto totalNumInputChannels  = getMainBusNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    const auto numChannels = juce::jmin(totalNumOutputChannels, buffer.getNumChannels());
+
+    // The envelope is only followed while it's blended in; the control segments read it back from processFilter.
+    // currentSettings is only refreshed further on, so the live value is checked too, or the block where EnvelopeMix
+    // leaves 0 would blend in an envelope left over from when it was last followed.
+    const auto envelopeNeeded = currentSettings.envelopeMix > 0 || parameterHandles.envelopeMix->load() > 0;
+
+    if (envelopeNeeded)
+    {
+        if (!followingEnvelope)
+            getEngines<SampleType>().envelope.reset();
+
+        followEnvelope(buffer, numChannels);
+    }
+
+    followingEnvelope = envelopeNeeded;
+
+    // A new oversampling choice, or the host switching between real time and offline rendering, takes effect here
+    const auto stage = getOversamplingStage();
+
+    if (stage != activeOversamplingStage)
+        selectOversampling<SampleType>(stage);
+
+    auto* oversampler = activeOversamplingStage >= 0 ? getEngines<SampleType>().oversamplers[(size_t)activeOversamplingStage].get() : nullptr;
+
+    if (oversampler == nullptr)
+    {
+        processAtFilterRate(buffer, numChannels);
+    }
+    else
+    {
+        // The oversampled samples are copied to a buffer of our own, so the filter can work on them like on the host's.
+        // The transport-stopped pass-through goes through the oversampler as well, to keep the reported latency.
+        auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, (size_t)numChannels);
+        auto oversampledBlock = oversampler->processSamplesUp(block);
+        auto& oversampledBuffer = getEngines<SampleType>().oversampledBuffer;
+
+        oversampledBuffer.setSize(numChannels, (int)oversampledBlock.getNumSamples(), false, false, true);
+        oversampledBlock.copyTo(oversampledBuffer);
+        processAtFilterRate(oversampledBuffer, numChannels);
+        oversampledBlock.copyFrom(oversampledBuffer);
+
+        oversampler->processSamplesDown(block);
+    }
+
+    // Hand the output to the spectrum analyser, only while an editor is showing it
+    if (spectrumFifo.isEnabled())
+        spectrumFifo.push(buffer, numChannels);
+}
+
+//Runs the envelope follower over the block's sidechain channels, or over the main input's when no sidechain is connected
+template <typename SampleType>
+void FunkyFilterAudioProcessor::followEnvelope(const juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
+{
+    std::array<const SampleType*, maximumNumChannels> channels;
+    int numDetectorChannels = 0;
+
+    const auto numSidechainChannels = getBusCount(true) > 1 ? getChannelCountOfBus(true, 1) : 0;
+
+    for (int channel = 0; channel < numSidechainChannels; ++channel)
+    {
+        const auto index = getChannelIndexInProcessBlockBuffer(true, 1, channel);
+
+        if (index < buffer.getNumChannels() && numDetectorChannels < maximumNumChannels)
+            channels[(size_t)numDetectorChannels++] = buffer.getReadPointer(index);
+    }
+
+    if (numSidechainChannels == 0)
+        for (int channel = 0; channel < numChannels; ++channel)
+            channels[(size_t)numDetectorChannels++] = buffer.getReadPointer(channel);
+
+    getEngines<SampleType>().envelope.process(channels.data(), numDetectorChannels, buffer.getNumSamples());
+}
+
+//Everything the filter does to a block, at the filter's rate: the host's sample rate times the oversampling factor
+template <typename SampleType>
+void FunkyFilterAudioProcessor::processAtFilterRate(juce::AudioBuffer<SampleType>& buffer, int numChannels)
+{
+    const auto inputSilent = isSilent(buffer, numChannels);
+
+    // Only a synced, looping transport sets a wrap point for this block
+    transportWrapSample = -1;
+
     // Check if there is a play head to get the current position info
     if (auto* playHead = getPlayHead())
     {
-        juce::AudioPlayHead::CurrentPositionInfo info;
-
         // Get the current position info from the play head
-        if (playHead->getCurrentPosition(info))
+        if (auto position = playHead->getPosition())
         {
-            if (info.isPlaying)
+            if (position->getIsPlaying())
+            {
+                // Update filter only when the transport is playing, and only recompute what the changed parameters affect.
+                // A restored state arrives as one complete snapshot. The parameters are only read outside of a restore:
+                // if one was writing before or during the read (restoreGeneration odd, or moved on) the read is
+                // dropped, and the changes are picked up again next block.
+                if (restoredSettings.acquire())
+                {
+                    currentSettings = restoredSettings.getReadBuffer();
+                    updateFilter(currentSettings, filterSampleRate, everythingChanged);
+                    startCrossfade<SampleType>();
+                }
+                else if (auto changes = changedParameters.exchange(0))
+                {
+                    const auto generation = restoreGeneration.load(std::memory_order_acquire);
+                    const auto settings = getFilterSettings(parameterHandles);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    if ((generation & 1) == 0 && restoreGeneration.load(std::memory_order_relaxed) == generation)
+                    {
+                        currentSettings = settings;
+                        updateFilter(currentSettings, filterSampleRate, changes);
+                    }
+                    else
+                    {
+                        changedParameters.fetch_or(changes);
+                    }
+                }
+
+                // Lock the LFO to the host's musical position (only in note duration mode with TransportSync on)
+                syncToTransport(*position, currentSettings, filterSampleRate, buffer.getNumSamples());
+
+                // Process every channel through the modulated filter
+                processFilter(buffer, currentSettings, inputSilent);
+            }
+            else if (inputSilent && !filterFlushed)
             {
-                // Update filter only when the transport is playing
-                auto filterSettings = getFilterSettings(tree);
-                updateFilter(filterSettings, getSampleRate(), buffer.getNumSamples());
-
-                // Create an AudioBlock from the buffer for DSP processing
-                juce::dsp::AudioBlock<float> block(buffer);
-                auto leftBlock = block.getSingleChannelBlock(0);
-                auto rightBlock = block.getSingleChannelBlock(1);
-
-                // Create process contexts for left and right channels
-                juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-                juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-
-                // Process the left and right channels through the filter
-                filterLeft.process(leftContext);
-                filterRight.process(rightContext);
+                // The transport just stopped: let the filter ring out over the silence, it flushes itself once the tail has decayed
+                processFilter(buffer, currentSettings, inputSilent);
             }
             else
             {
-                // Reset phase when playback stops
+                // Reset phase when playback stops, and clear the filter so nothing stale rings when it starts again
                 phase = 0.f;
+
+                if (!filterFlushed)
+                    flushFilter();
             }
         }
     }
@@ -189,77 +416,697 @@ void FunkyFilterAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 //==============================================================================
 bool FunkyFilterAudioProcessor::hasEditor() const
 {
-    return true; // (change this to false if you choose to not supply an editor)
+    return ! FUNKYFILTER_HEADLESS; // (change this to false if you choose to not supply an editor)
 }
 
 juce::AudioProcessorEditor* FunkyFilterAudioProcessor::createEditor()
 {
+   #if FUNKYFILTER_HEADLESS
+    return nullptr;
+   #else
     return new FunkyFilterAudioProcessorEditor (*this);
+   #endif
 }
 
 //==============================================================================
+//Saves every parameter's plain value in the compact binary state format (see PresetState)
 void FunkyFilterAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    auto values = PresetState::makeDefaultValues();
 
-    juce::MemoryOutputStream mos(destData, true);
-    tree.state.writeToStream(mos);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = stateParameters[i]->convertFrom0to1(stateParameters[i]->getValue());
 
+    juce::MemoryOutputStream mos(destData, true);
+    PresetState::write(values, mos);
 }
 
+//Restores a binary state, or the ValueTree that earlier versions saved; anything else is ignored
 void FunkyFilterAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    auto values = PresetState::makeDefaultValues();
 
-    auto valueTree = juce::ValueTree::readFromData(data, sizeInBytes);
+    if (sizeInBytes > 0 && PresetState::read(data, (size_t)sizeInBytes, values))
+        applyState(values);
+}
 
-    if (valueTree.isValid())
+//Writes a whole state to the parameters (unset values go back to their defaults) and hands the audio thread the
+//resulting settings as one snapshot. Called from the host's threads, never the audio thread.
+void FunkyFilterAudioProcessor::applyState(const PresetState::Values& values)
+{
+    const juce::ScopedLock lock(stateLock);
+
+    // Odd until every parameter has its new value, so the audio thread can tell its read of the parameters overlapped
+    // this one's writes and discard it
+    restoreGeneration.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < values.size(); ++i)
     {
-        tree.replaceState(valueTree);
-        updateFilter(getFilterSettings(tree), getSampleRate(), getBlockSize());
+        auto* parameter = stateParameters[i];
+        parameter->setValueNotifyingHost(std::isnan(values[i]) ? parameter->getDefaultValue() : parameter->convertTo0to1(values[i]));
     }
 
+    // Read back through the handles, so choices and steps are snapped exactly as the parameters snapped them
+    restoredSettings.getWriteBuffer() = getFilterSettings(parameterHandles);
+    restoredSettings.publish();
+
+    restoreGeneration.fetch_add(1, std::memory_order_release);
+}
+
+//Flags which part of the derived filter state a parameter change invalidates; called from whichever thread set it
+void FunkyFilterAudioProcessor::parameterChanged(const juce::String& parameterID, float)
+{
+    if (parameterID == "MinimumFrequency" || parameterID == "MaximumFrequency")
+        changedParameters.fetch_or(rangeChanged);
+    else if (parameterID == "FilterQuality")
+        changedParameters.fetch_or(qualityChanged);
+    else if (parameterID == "CoefficientTable" || parameterID == "FastMath")
+        changedParameters.fetch_or(otherChanged);
+    else if (parameterID == "FilterEngine" || parameterID == "FilterType" || parameterID == "BankVoices")
+        changedParameters.fetch_or(engineChanged);
+    else if (parameterID == "EnvelopeAttack" || parameterID == "EnvelopeRelease" || parameterID == "EnvelopeDetector")
+        changedParameters.fetch_or(envelopeChanged);
+    else if (parameterID == "Oversampling" || parameterID == "OfflineOversampling" || parameterID == "OversamplingFilter")
+        latencyChanged.store(true); // The audio thread switches stages by itself, the timer tells the host
+    else
+        changedParameters.fetch_or(modulationChanged);
 }
 
-//Udpates filter coefficients
-void FunkyFilterAudioProcessor::updateFilter(const FilterSettings& filterSettings, double sampleRate, int blockSize)
+//Udpates the state derived from the parameters (LFO increment per sample, control rate, log frequency range and Q axis position).
+//Only the parts affected by the changed bits are recomputed.
+void FunkyFilterAudioProcessor::updateFilter(const FilterSettings& filterSettings, double sampleRate, juce::uint32 changes)
 {
+    if (changes & rangeChanged)
+    {
+        // Precompute the log range so mapping an LFO position to a frequency needs a single pow
+        logMinimumFrequency = std::log10(filterSettings.minimumFrequency);
+        logFrequencyRange = std::log10(filterSettings.maximumFrequency) - logMinimumFrequency;
+    }
+
+    if (changes & qualityChanged)
+        qualityPoint = CoefficientTable::getQualityPoint(filterSettings.filterQuality);
+
+    // The longest ring is at the lowest cutoff the LFO reaches
+    if (changes & (rangeChanged | qualityChanged))
+    {
+        const auto lowestFrequency = juce::jmin(filterSettings.minimumFrequency, filterSettings.maximumFrequency);
+        const auto decaySamples = getFilterDecaySamples(lowestFrequency, filterSettings.filterQuality, sampleRate, tailDecibels);
+        tailSamples = (int)juce::jmin(std::ceil(decaySamples), (double)std::numeric_limits<int>::max());
+    }
+
+    if (changes & engineChanged)
+    {
+        // The SVF's outputs share one state, so changing the type needs no reset. Switching engines does, since one
+        // design's state means nothing to the other; the newly selected one starts from silence at the LFO position.
+        floatEngines.stateVariable.setOutput(filterSettings.filterTypeIndex);
+        doubleEngines.stateVariable.setOutput(filterSettings.filterTypeIndex);
+
+        // Changing the number of bank voices needs no reset either, the added or removed voices ramp in or out
+        const auto bankSelected = filterSettings.bankVoices > 1;
+
+        if (filterSettings.useStateVariableFilter != stateVariableFilterActive || bankSelected != bankActive)
+        {
+            stateVariableFilterActive = filterSettings.useStateVariableFilter;
+            bankActive = bankSelected;
+            flushFilter();
+        }
+    }
+
+    // The followers run at the host's rate, which they were prepared with
+    if (changes & envelopeChanged)
+    {
+        floatEngines.envelope.setParameters(filterSettings.envelopeAttack, filterSettings.envelopeRelease, filterSettings.useRmsDetector);
+        doubleEngines.envelope.setParameters(filterSettings.envelopeAttack, filterSettings.envelopeRelease, filterSettings.useRmsDetector);
+    }
+
+    // The bank's voices divide BankSpread octaves evenly, so the top voice sits BankSpread octaves above the first
+    // however many there are. A fixed step per voice put most of eight voices at the Nyquist clamp.
+    if (changes & (modulationChanged | engineChanged))
+    {
+        const auto octavesPerVoice = filterSettings.bankVoices > 1 ? (double)filterSettings.bankSpread / (filterSettings.bankVoices - 1) : 0.0;
+
+        for (size_t voice = 0; voice < bankFrequencyRatios.size(); ++voice)
+            bankFrequencyRatios[voice] = std::exp2((double)voice * octavesPerVoice);
+    }
+
+    if ((changes & modulationChanged) == 0)
+        return;
+
     // Check if the filter frequency modulation should use note duration based on the parameter value
     if (filterSettings.useNoteDuration)
     {
-        // Define an array of note durations (whole note, half note, etc.)
-        float noteDurations[] = { 4.0f, 2.f, 1.f, 0.5f, 0.25f };
-
-        // Get the current note duration from the array based on the parameter value
-        float noteDuration = noteDurations[filterSettings.noteDurationIndex];
+        // Get the current note duration (whole note, half note, etc.) based on the parameter value
+        auto noteDuration = noteDurations[filterSettings.noteDurationIndex];
 
         // Calculate the modulation frequency based on BPM and note duration (LFO frequency)
-        float modFrequency = filterSettings.bpm / (60 * noteDuration);
+        auto modFrequency = filterSettings.bpm / (60 * noteDuration);
 
-        // Calculate the phase increment for the LFO based on modulation frequency, sample rate, and block size
-        increment = modFrequency * wavetableSize / (sampleRate / (float)blockSize);
+        // Calculate the per-sample phase increment for the LFO based on modulation frequency and sample rate
+        increment = modFrequency / sampleRate;
     }
     else
     {
-        // Calculate the phase increment for the LFO using a fixed frequency from the parameter tree
-        increment = filterSettings.lfoFreq * wavetableSize / (sampleRate / (float)blockSize);
+        // Calculate the per-sample phase increment for the LFO using a fixed frequency from the parameter tree
+        increment = filterSettings.lfoFreq / sampleRate;
     }
 
-    // Map the current phase value in the wavetable t   o a logarithmic frequency range
-    currentFilterFrequency = juce::mapToLog10(wavetable[(int)phase], filterSettings.minimumFrequency, filterSettings.maximumFrequency);
+    // A sample & hold table spans several LFO cycles, one step each
+    cyclesPerTable = LfoShapeBank::getCyclesPerTable(filterSettings.lfoShapeIndex);
+    increment /= cyclesPerTable;
+
+    // StereoSpread is in degrees of one LFO cycle
+    stereoPhaseOffset = filterSettings.stereoSpread / 360.0 / cyclesPerTable;
+
+    // Number of samples between coefficient updates (1 means the cutoff is recomputed for every sample).
+    // These count samples at the host's rate, so oversampling doesn't multiply the number of updates.
+    int controlIntervals[] = { 1, 16, 32, 64 };
+    controlInterval = controlIntervals[filterSettings.controlRateIndex] * oversamplingFactor;
+}
+
+//Derives the LFO phase and rate for this block from the host's ppqPosition and tempo, so the sweep is locked to the
+//grid: the same musical position always gives the same phase, however the transport got there, and nothing accumulates
+//from block to block. JUCE only reports the transport at block starts, so a tempo change takes effect at the next block,
+//where the phase is re-derived exactly. A loop wrap inside the block is located to the sample and processFilter splits
+//the block there.
+void FunkyFilterAudioProcessor::syncToTransport(const juce::AudioPlayHead::PositionInfo& position, const FilterSettings& filterSettings,
+                                                double sampleRate, int numSamples)
+{
+    if (!filterSettings.useNoteDuration || !filterSettings.useTransportSync)
+        return;
+
+    const auto ppqPosition = position.getPpqPosition();
+    const auto bpm = position.getBpm();
+
+    // Without a musical position the LFO keeps free-running at the BPM parameter's rate
+    if (!ppqPosition.hasValue() || !bpm.hasValue() || *bpm <= 0 || sampleRate <= 0)
+        return;
+
+    const auto beatsPerTable = noteDurations[filterSettings.noteDurationIndex] * cyclesPerTable;
+    const auto beatsPerSample = *bpm / (60.0 * sampleRate);
+    const auto getPhaseForPosition = [beatsPerTable](double ppq) { return ppq / beatsPerTable - std::floor(ppq / beatsPerTable); };
+
+    increment = beatsPerSample / beatsPerTable;
+    phase = getPhaseForPosition(*ppqPosition);
 
-    // Increment the phase and wrap it around using fmod to stay within the wavetable size
-    phase = fmod(phase + increment, wavetableSize);
+    const auto loopPoints = position.getLoopPoints();
 
-    // Generate new band-pass filter coefficients based on (fixed or calculated) frequency and quality factor
-    auto filterCoefficients = makeBandPassFilter(currentFilterFrequency, filterSettings.filterQuality, sampleRate);
+    if (!position.getIsLooping() || !loopPoints.hasValue() || loopPoints->ppqEnd <= loopPoints->ppqStart
+        || *ppqPosition >= loopPoints->ppqEnd)
+        return;
 
-    // Update the left and right filter coefficients with the new ones
-    updateCoefficients(filterLeft.coefficients, filterCoefficients);
-    updateCoefficients(filterRight.coefficients, filterCoefficients);
+    // The first sample at or past the loop end plays the loop start, offset by however far past the end it falls
+    const auto samplesToLoopEnd = (loopPoints->ppqEnd - *ppqPosition) / beatsPerSample;
+    const auto wrapSample = std::ceil(samplesToLoopEnd);
+
+    if (wrapSample >= numSamples)
+        return;
+
+    transportWrapSample = (int)wrapSample;
+    transportWrapPhase = getPhaseForPosition(loopPoints->ppqStart + (wrapSample - samplesToLoopEnd) * beatsPerSample);
+}
+
+//Jumps the filter coefficients straight to the current LFO position, without ramping
+template <typename SampleType>
+void FunkyFilterAudioProcessor::resetFilter(const FilterSettings& filterSettings, double sampleRate)
+{
+    auto& engines = getEngines<SampleType>();
+
+    advanceModulation<SampleType>(filterSettings, sampleRate, 0);
+    engines.biquad.setCoefficients(engines.targetCoefficients.data(), engines.targetCoefficients.data() + 5);
+    engines.stateVariable.setParameters(engines.targetStateVariable.data(), engines.targetStateVariable.data() + 2);
+    engines.bank.setCoefficients(engines.targetBank.data(), filterSettings.bankVoices);
+}
+
+//Advances the LFO by the given number of samples and computes the coefficients for the cutoff it lands on
+template <typename SampleType>
+void FunkyFilterAudioProcessor::advanceModulation(const FilterSettings& filterSettings, double sampleRate, int numSamples)
+{
+    auto& engines = getEngines<SampleType>();
+
+    // Increment the phase and wrap it around to stay within the table
+    phase += increment * numSamples;
+    phase -= std::floor(phase);
+    modulationSample += numSamples;
+
+    // Current position of the LFO between the minimum and maximum frequency, interpolated from the selected shape,
+    // and blended with the envelope's
+    auto position = getModulationPosition<SampleType>(filterSettings, LfoShapeBank::lookup(filterSettings.lfoShapeIndex, phase));
+    currentPosition = position;
+
+    if (filterSettings.bankVoices > 1)
+    {
+        // Every voice reads the same shape at its own phase, and the summed voices are scaled to keep the level similar
+        const auto gain = 1.0 / std::sqrt((double)filterSettings.bankVoices);
+        const auto voicePhaseOffset = filterSettings.bankPhaseOffset / cyclesPerTable;
+
+        for (int voice = 0; voice < filterSettings.bankVoices; ++voice)
+        {
+            auto voicePhase = phase - voice * voicePhaseOffset;
+            voicePhase -= std::floor(voicePhase);
+
+            const auto voicePosition = voice == 0 ? position
+                                                  : getModulationPosition<SampleType>(filterSettings, LfoShapeBank::lookup(filterSettings.lfoShapeIndex, voicePhase));
+            const auto frequency = getFrequencyForPosition(voicePosition, filterSettings.useFastMath) * bankFrequencyRatios[(size_t)voice];
+            voiceFrequencies[(size_t)voice] = frequency;
+
+            auto* c = engines.targetBank.data() + 5 * voice;
+            makeBandPassFilter(c, frequency, filterSettings.filterQuality, sampleRate, filterSettings.useFastMath);
+            c[0] *= (SampleType)gain;
+            c[2] *= (SampleType)gain;
+        }
+
+        return;
+    }
+
+    // The right channels read the shape StereoSpread further on; without it, or without any left/right pair in the
+    // layout, they share the left channels' targets
+    const auto stereo = stereoPhaseOffset > 0 && hasStereoPairs;
+    auto rightPosition = position;
+
+    if (stereo)
+    {
+        auto rightPhase = phase + stereoPhaseOffset;
+        rightPhase -= std::floor(rightPhase);
+        rightPosition = getModulationPosition<SampleType>(filterSettings, LfoShapeBank::lookup(filterSettings.lfoShapeIndex, rightPhase));
+    }
+
+    if (filterSettings.useStateVariableFilter)
+    {
+        // The SVF only needs one tan per cutoff change, and with StereoSpread both sides' come from one two-lane step
+        auto* p = engines.targetStateVariable.data();
+
+        if (stereo)
+        {
+            makeStateVariableParameterPair(p, p + 2, getFrequencyForPosition(position, filterSettings.useFastMath),
+                                           getFrequencyForPosition(rightPosition, filterSettings.useFastMath),
+                                           filterSettings.filterQuality, sampleRate, filterSettings.useFastMath);
+        }
+        else
+        {
+            makeStateVariableParameters(p, getFrequencyForPosition(position, filterSettings.useFastMath),
+                                        filterSettings.filterQuality, sampleRate, filterSettings.useFastMath);
+            std::copy(p, p + 2, p + 2);
+        }
+
+        return;
+    }
+
+    auto* c = engines.targetCoefficients.data();
+
+    if (coefficientTable != nullptr)
+    {
+        // Interpolate the precomputed coefficients, which avoids the log mapping and trig entirely
+        coefficientTable->lookup(c, position, qualityPoint);
+
+        if (stereo)
+            coefficientTable->lookup(c + 5, rightPosition, qualityPoint);
+        else
+            std::copy(c, c + 5, c + 5);
+
+        return;
+    }
+
+    // Map the current LFO position to a logarithmic frequency range
+    auto filterFrequency = getFrequencyForPosition(position, filterSettings.useFastMath);
+
+    // Generate band-pass coefficients based on (fixed or calculated) frequency and quality factor, for both sides
+    // at once with StereoSpread
+    if (stereo)
+    {
+        makeBandPassFilterPair(c, c + 5, filterFrequency, getFrequencyForPosition(rightPosition, filterSettings.useFastMath),
+                               filterSettings.filterQuality, sampleRate, filterSettings.useFastMath);
+    }
+    else
+    {
+        makeBandPassFilter(c, filterFrequency, filterSettings.filterQuality, sampleRate, filterSettings.useFastMath);
+        std::copy(c, c + 5, c + 5);
+    }
+}
+
+//Runs the buffer through the filter, updating the cutoff once per control interval.
+//Between updates the coefficients are ramped linearly towards the next target, so the sweep is smooth and
+//independent of the host block size. The stability region of a biquad's denominator is convex, so every
+//intermediate set between two stable band-pass designs is stable as well.
+template <typename SampleType>
+void FunkyFilterAudioProcessor::processFilter(juce::AudioBuffer<SampleType>& buffer, const FilterSettings& filterSettings, bool inputSilent)
+{
+    auto& engines = getEngines<SampleType>();
+    const auto numChannels = juce::jmin(getTotalNumOutputChannels(), buffer.getNumChannels());
+    const auto numSamples = buffer.getNumSamples();
+    const auto sampleRate = filterSampleRate;
+
+    // The bank takes precedence over the engine choice
+    const auto useBank = filterSettings.bankVoices > 1;
+    const auto useStateVariableFilter = !useBank && filterSettings.useStateVariableFilter;
+
+    // advanceModulation reads the envelope from the start of the host's block
+    modulationSample = 0;
+
+    // Use the coefficient table if it's enabled and already built for the current range and sample rate.
+    // It holds the single band's biquad coefficients, so neither the SVF engine nor the bank asks for one.
+    coefficientTable = filterSettings.useCoefficientTable && !useStateVariableFilter && !useBank
+        ? coefficientTableCache.getTable(filterSettings.minimumFrequency, filterSettings.maximumFrequency, sampleRate)
+        : nullptr;
+
+    if (skipSilentBlock<SampleType>(inputSilent, filterSettings, sampleRate, numSamples))
+    {
+        // Nothing to filter, but the LFO keeps moving so it's in the right place when sound returns
+        if (transportWrapSample >= 0)
+        {
+            phase = transportWrapPhase - increment * transportWrapSample;
+            phase -= std::floor(phase);
+        }
+
+        advanceModulation<SampleType>(filterSettings, sampleRate, numSamples);
+        publishFilterFrequencies(filterSettings.bankVoices);
+        return;
+    }
+
+    // Telemetry is only gathered while an editor is listening, at the same number of steps per block with oversampling
+    const auto recordTelemetry = telemetry.isEnabled();
+    const auto telemetryStep = minimumTelemetryStep * oversamplingFactor;
+    int numPendingSteps = 0, telemetryLength = 0;
+
+    // Move all channels into SIMD lanes once, so every segment below filters them together.
+    // The bank keeps its voices in the lanes instead, and filters each channel in place.
+    if (useStateVariableFilter)
+        engines.stateVariable.load(buffer.getArrayOfReadPointers(), numChannels, numSamples);
+    else if (!useBank)
+        engines.biquad.load(buffer.getArrayOfReadPointers(), numChannels, numSamples);
+
+    for (int start = 0; start < numSamples;)
+    {
+        // A segment never crosses the transport's loop wrap, so the LFO can jump back exactly there
+        auto segmentLength = juce::jmin(controlInterval, numSamples - start);
+
+        if (start < transportWrapSample)
+            segmentLength = juce::jmin(segmentLength, transportWrapSample - start);
+        else if (start == transportWrapSample)
+            phase = transportWrapPhase;
+
+        // Advance the LFO to the end of this segment and compute the coefficients it should arrive at
+        advanceModulation<SampleType>(filterSettings, sampleRate, segmentLength);
+
+        if (crossfadeRemaining > 0)
+            applyCrossfade<SampleType>(segmentLength);
+
+        // Ramp towards the target over the segment
+        if (useBank)
+            engines.bank.process(buffer.getArrayOfWritePointers(), numChannels, start, segmentLength,
+                                 engines.targetBank.data(), filterSettings.bankVoices);
+        else if (useStateVariableFilter)
+            engines.stateVariable.process(start, segmentLength, engines.targetStateVariable.data(), engines.targetStateVariable.data() + 2);
+        else
+            engines.biquad.process(start, segmentLength, engines.targetCoefficients.data(), engines.targetCoefficients.data() + 5);
+
+        if (recordTelemetry)
+        {
+            // Short steps are merged so per-sample modulation doesn't flood the queue
+            telemetryLength += segmentLength;
+
+            if ((telemetryLength >= telemetryStep || start + segmentLength == numSamples)
+                && numPendingSteps < (int)pendingSteps.size())
+            {
+                pendingSteps[(size_t)numPendingSteps++] = { start + segmentLength - telemetryLength, telemetryLength,
+                                                            currentPosition, (float)getCyclePhase() };
+                telemetryLength = 0;
+            }
+        }
+
+        start += segmentLength;
+    }
+
+    if (useStateVariableFilter)
+        engines.stateVariable.store(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+    else if (!useBank)
+        engines.biquad.store(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+    // The displayed cutoff only needs updating once per block
+    publishFilterFrequencies(filterSettings.bankVoices);
+
+    if (recordTelemetry)
+        pushTelemetry(buffer, numChannels, numPendingSteps);
+}
+
+//Measures the output level of each pending modulation step and hands the records to the editor
+template <typename SampleType>
+void FunkyFilterAudioProcessor::pushTelemetry(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numPendingSteps)
+{
+    for (int i = 0; i < numPendingSteps; ++i)
+    {
+        const auto& step = pendingSteps[(size_t)i];
+
+        ModulationRecord record;
+        record.cutoff = getFrequencyForPosition(step.position);
+        record.phase = step.phase;
+
+        float sumOfSquares = 0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            record.peak = juce::jmax(record.peak, (float)buffer.getMagnitude(channel, step.startSample, step.numSamples));
+            sumOfSquares += (float)juce::square(buffer.getRMSLevel(channel, step.startSample, step.numSamples));
+        }
+
+        record.rms = std::sqrt(sumOfSquares / (float)juce::jmax(1, numChannels));
+
+        // If the editor has fallen behind the record is dropped, the audio thread never waits
+        telemetry.push(record);
+    }
+}
+
+//Returns true if the block doesn't need filtering: the input has been silent for longer than the filter takes to ring out,
+//so the output would be silent too. The state is flushed the first time, and when sound returns the coefficients jump
+//straight to the current LFO position.
+template <typename SampleType>
+bool FunkyFilterAudioProcessor::skipSilentBlock(bool inputSilent, const FilterSettings& filterSettings, double sampleRate, int numSamples)
+{
+    if (!inputSilent)
+    {
+        silentSamples = 0;
+
+        if (filterFlushed)
+        {
+            filterFlushed = false;
+            resetFilter<SampleType>(filterSettings, sampleRate);
+        }
+
+        return false;
+    }
+
+    if (filterFlushed)
+        return true;
+
+    // Counted before this block, so the last block of the tail is still filtered
+    if (silentSamples < tailSamples)
+    {
+        silentSamples += numSamples;
+        return false;
+    }
+
+    flushFilter();
+    return true;
+}
+
+void FunkyFilterAudioProcessor::flushFilter()
+{
+    floatEngines.biquad.reset();
+    floatEngines.stateVariable.reset();
+    doubleEngines.biquad.reset();
+    doubleEngines.stateVariable.reset();
+    floatEngines.bank.reset();
+    doubleEngines.bank.reset();
+    filterFlushed = true;
+
+    // Coefficients restart from the LFO position, there is nothing left to fade from
+    crossfadeRemaining = 0;
+}
+
+//Holds on to the coefficients the filter has arrived at, so a new state fades in from them instead of jumping.
+//If the new state switched engines the filter was flushed, and starts from its new coefficients anyway.
+template <typename SampleType>
+void FunkyFilterAudioProcessor::startCrossfade() noexcept
+{
+    if (filterFlushed)
+        return;
+
+    auto& engines = getEngines<SampleType>();
+    engines.fadeCoefficients = engines.targetCoefficients;
+    engines.fadeStateVariable = engines.targetStateVariable;
+    engines.fadeBank = engines.targetBank;
+    crossfadeRemaining = crossfadeSamples;
+}
+
+//Blends the targets of the segment just computed with the ones held by startCrossfade, by how much of the fade is left.
+//The engines ramp linearly between targets, so the crossfade is piecewise linear at the control rate. Like the ramps,
+//a blend of two stable designs is stable: the biquad's stability region is convex, and so are the SVF's g, k > 0.
+template <typename SampleType>
+void FunkyFilterAudioProcessor::applyCrossfade(int numSamples) noexcept
+{
+    auto& engines = getEngines<SampleType>();
+
+    crossfadeRemaining = juce::jmax(0, crossfadeRemaining - numSamples);
+    const auto amount = (SampleType)crossfadeRemaining / (SampleType)crossfadeSamples;
+
+    // Only one engine is running, but blending all of them costs less than telling which
+    const auto blend = [amount](auto& target, const auto& held)
+    {
+        for (size_t i = 0; i < target.size(); ++i)
+            target[i] += (held[i] - target[i]) * amount;
+    };
+
+    blend(engines.targetCoefficients, engines.fadeCoefficients);
+    blend(engines.targetStateVariable, engines.fadeStateVariable);
+    blend(engines.targetBank, engines.fadeBank);
+}
+
+//Builds every oversampling stage for the given channel count and host block size (none for zero channels), and notes
+//each one's latency. The IIR stages delay by a few samples but shift the phase near the top of the band, the FIR ones
+//are linear phase with more delay. The oversampler pads either to a whole number of samples, so the reported latency is exact.
+template <typename SampleType>
+void FunkyFilterAudioProcessor::prepareOversampling(int numChannels, int samplesPerBlock)
+{
+    auto& engines = getEngines<SampleType>();
+
+    for (size_t stage = 0; stage < engines.oversamplers.size(); ++stage)
+    {
+        auto& oversampler = engines.oversamplers[stage];
+        oversampler = nullptr;
+
+        if (numChannels == 0)
+            continue;
+
+        // The first three stages are 2x, 4x and 8x (one, two or three halfband steps) with IIR filters, then again with FIR
+        const auto filterType = (int)stage < numOversamplingFactors ? juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR
+                                                                    : juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple;
+        const auto numHalfBandSteps = stage % numOversamplingFactors + 1;
+
+        oversampler = std::make_unique<juce::dsp::Oversampling<SampleType>>((size_t)numChannels, numHalfBandSteps, filterType, true, true);
+        oversampler->initProcessing((size_t)samplesPerBlock);
+        oversamplingLatencies[stage].store(juce::roundToInt(oversampler->getLatencyInSamples()));
+    }
+
+    engines.oversampledBuffer.setSize(numChannels, numChannels > 0 ? samplesPerBlock * maximumOversamplingFactor : 0);
+}
+
+//Switches to another oversampling stage (-1 for none). The filter restarts from silence at the new rate, and everything
+//derived from the sample rate is recomputed; the stage itself was cleared, so nothing from its last use leaks through.
+template <typename SampleType>
+void FunkyFilterAudioProcessor::selectOversampling(int stage)
+{
+    auto* oversampler = stage >= 0 ? getEngines<SampleType>().oversamplers[(size_t)stage].get() : nullptr;
+
+    activeOversamplingStage = stage;
+    oversamplingFactor = oversampler != nullptr ? (int)oversampler->getOversamplingFactor() : 1;
+    filterSampleRate = getSampleRate() * oversamplingFactor;
+    currentFilterSampleRate.store(filterSampleRate, std::memory_order_relaxed);
+
+    if (oversampler != nullptr)
+        oversampler->reset();
+
+    flushFilter();
+    silentSamples = 0;
+
+    // A restored state or preset fades in over the same time whatever the rate
+    crossfadeSamples = juce::jmax(1, juce::roundToInt(crossfadeSeconds * filterSampleRate));
+
+    updateFilter(currentSettings, filterSampleRate, everythingChanged);
+}
+
+//Oversampling stage for the current parameters: the real time or the offline factor, depending on how the host is
+//rendering, with the selected filter design. -1 when that factor is off.
+int FunkyFilterAudioProcessor::getOversamplingStage() const noexcept
+{
+    const auto factorIndex = (int)(isNonRealtime() ? parameterHandles.offlineOversampling : parameterHandles.oversampling)->load();
+
+    if (factorIndex == 0)
+        return -1;
+
+    return (int)parameterHandles.oversamplingFilter->load() * numOversamplingFactors + factorIndex - 1;
+}
+
+//The channels of a layout that take the right side's coefficients: each right channel whose left partner is there too.
+//Centre, LFE, ambisonic and discrete channels, and a side without its partner, share the left side's.
+juce::BigInteger FunkyFilterAudioProcessor::getRightChannels(const juce::AudioChannelSet& layout)
+{
+    using Set = juce::AudioChannelSet;
+
+    static constexpr std::pair<Set::ChannelType, Set::ChannelType> pairs[] = {
+        { Set::left, Set::right },
+        { Set::leftCentre, Set::rightCentre },
+        { Set::leftSurround, Set::rightSurround },
+        { Set::leftSurroundSide, Set::rightSurroundSide },
+        { Set::leftSurroundRear, Set::rightSurroundRear },
+        { Set::wideLeft, Set::wideRight },
+        { Set::topFrontLeft, Set::topFrontRight },
+        { Set::topSideLeft, Set::topSideRight },
+        { Set::topRearLeft, Set::topRearRight }
+    };
+
+    juce::BigInteger rightChannels;
+
+    for (const auto& [left, right] : pairs)
+    {
+        const auto rightIndex = layout.getChannelIndexForType(right);
+
+        if (rightIndex >= 0 && layout.getChannelIndexForType(left) >= 0)
+            rightChannels.setBit(rightIndex);
+    }
+
+    return rightChannels;
+}
+
+//Reports the latency of the stage the current parameters select. The latencies were measured when the stages were
+//built, so this only reads atomics; it's called from prepareToPlay, setNonRealtime and the timer, never the audio thread.
+void FunkyFilterAudioProcessor::updateLatency()
+{
+    const auto stage = getOversamplingStage();
+    setLatencySamples(stage >= 0 ? oversamplingLatencies[(size_t)stage].load() : 0);
+}
+
+//Passes an oversampling change on to the host from the message thread, since setLatencySamples notifies it synchronously
+void FunkyFilterAudioProcessor::timerCallback()
+{
+    if (latencyChanged.exchange(false))
+        updateLatency();
+}
+
+template <typename SampleType>
+bool FunkyFilterAudioProcessor::isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) > silenceThreshold)
+            return false;
+
+    return true;
+}
+
+//Maps a normalised LFO position to its cutoff between the minimum and maximum frequency (logarithmically)
+float FunkyFilterAudioProcessor::getFrequencyForPosition(float position, bool useFastMath) const noexcept
+{
+    return mapPositionToFrequency(position, logMinimumFrequency, logFrequencyRange, useFastMath);
+}
+
+//Blends an LFO position with the envelope's at the current modulation sample, by EnvelopeMix. The envelope covers the
+//host's block, so with oversampling the sample is scaled back down to the host's rate.
+template <typename SampleType>
+float FunkyFilterAudioProcessor::getModulationPosition(const FilterSettings& filterSettings, float lfoPosition) noexcept
+{
+    if (filterSettings.envelopeMix <= 0)
+        return lfoPosition;
+
+    const auto envelopePosition = getEngines<SampleType>().envelope.getPosition(modulationSample / oversamplingFactor);
+    return lfoPosition + (envelopePosition - lfoPosition) * filterSettings.envelopeMix;
+}
+
+//Hands the cutoff (and each bank voice's) to the editor, once per block
+void FunkyFilterAudioProcessor::publishFilterFrequencies(int numVoices) noexcept
+{
+    currentFilterFrequency.store(getFrequencyForPosition(currentPosition), std::memory_order_relaxed);
+
+    for (int voice = 1; voice < numVoices; ++voice)
+        currentVoiceFrequencies[(size_t)voice].store(voiceFrequencies[(size_t)voice], std::memory_order_relaxed);
 }
 
 //Parameters are created here
@@ -296,6 +1143,11 @@ juce::AudioProcessorValueTreeState::ParameterLayout FunkyFilterAudioProcessor::c
             "UseNoteDuration",
             false));
 
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+            "TransportSync",
+            "TransportSync",
+            false));
+
     layout.add(std::make_unique<juce::AudioParameterFloat>(
             "BPM",
             "BPM",
@@ -307,20 +1159,158 @@ juce::AudioProcessorValueTreeState::ParameterLayout FunkyFilterAudioProcessor::c
             "NoteDuration",
             juce::StringArray{ "1 Note", "1/2 Note", "1/4 Note", "1/8 Note", "1/16 Note" },
             2));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "ControlRate",
+            "ControlRate",
+            juce::StringArray{ "Every Sample", "16 Samples", "32 Samples", "64 Samples" },
+            2));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+            "CoefficientTable",
+            "CoefficientTable",
+            false));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "FilterEngine",
+            "FilterEngine",
+            juce::StringArray{ "Biquad", "State Variable" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "FilterType",
+            "FilterType",
+            juce::StringArray{ "Band Pass", "Low Pass", "High Pass", "Notch" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "LfoShape",
+            "LfoShape",
+            juce::StringArray{ "Sine", "Triangle", "Saw", "Square", "Sample & Hold" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "BankVoices",
+            "BankVoices",
+            juce::StringArray{ "Off", "2 Voices", "3 Voices", "4 Voices", "5 Voices", "6 Voices", "7 Voices", "8 Voices" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "BankSpread",
+            "BankSpread",
+            juce::NormalisableRange<float>(0.0f, 4.0f, 0.01f, 1.0f),
+            2.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "BankPhaseOffset",
+            "BankPhaseOffset",
+            juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f, 1.0f),
+            0.25f));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+            "FastMath",
+            "FastMath",
+            false));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "Oversampling",
+            "Oversampling",
+            juce::StringArray{ "Off", "2x", "4x", "8x" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "OfflineOversampling",
+            "OfflineOversampling",
+            juce::StringArray{ "Off", "2x", "4x", "8x" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "OversamplingFilter",
+            "OversamplingFilter",
+            juce::StringArray{ "Polyphase IIR", "Linear Phase FIR" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "EnvelopeMix",
+            "EnvelopeMix",
+            juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f, 1.0f),
+            0.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "EnvelopeAttack",
+            "EnvelopeAttack",
+            juce::NormalisableRange<float>(0.1f, 100.0f, 0.1f, 0.4f),
+            10.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "EnvelopeRelease",
+            "EnvelopeRelease",
+            juce::NormalisableRange<float>(5.0f, 2000.0f, 1.0f, 0.4f),
+            200.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+            "EnvelopeDetector",
+            "EnvelopeDetector",
+            juce::StringArray{ "Peak", "RMS" },
+            0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+            "StereoSpread",
+            "StereoSpread",
+            juce::NormalisableRange<float>(0.0f, 180.0f, 1.0f, 1.0f),
+            0.0f));
     return layout;
 }
 
-//One cycle of a cosine wave
-void FunkyFilterAudioProcessor::initiateWavetable()
+//Phase within the current LFO cycle (rather than within the table, which may span several cycles)
+double FunkyFilterAudioProcessor::getCyclePhase() const noexcept
 {
-    for (int i = 0; i < wavetableSize; i++) wavetable.insert(i, (cos(2.0 * juce::double_Pi * i / wavetableSize) + 1) / 2);
+    const auto cyclePhase = phase * cyclesPerTable;
+    return cyclePhase - std::floor(cyclePhase);
 }
 
-
 //Helper funnction to get the mod frequency to PluginEditor
 double FunkyFilterAudioProcessor::getCurrentFilterFrequency() const
 {
-    return currentFilterFrequency;
+    return currentFilterFrequency.load(std::memory_order_relaxed);
+}
+
+//Rate the filter runs at (the sample rate times the oversampling factor), which its response has to be drawn at
+double FunkyFilterAudioProcessor::getFilterSampleRate() const
+{
+    return currentFilterSampleRate.load(std::memory_order_relaxed);
+}
+
+//Cutoff of a bank voice (voice 0 is the main cutoff), only meaningful while the bank is active
+double FunkyFilterAudioProcessor::getCurrentVoiceFrequency(int voice) const
+{
+    if (voice == 0)
+        return getCurrentFilterFrequency();
+
+    return currentVoiceFrequencies[(size_t)voice].load(std::memory_order_relaxed);
+}
+
+//Queue of per-step modulation records from the audio thread, for the editor to drain
+ModulationTelemetry& FunkyFilterAudioProcessor::getTelemetry()
+{
+    return telemetry;
+}
+
+SpectrumFifo& FunkyFilterAudioProcessor::getSpectrumFifo()
+{
+    return spectrumFifo;
+}
+
+//Block timing statistics and the optional trace, for the editor's load meter
+ProcessLoadMonitor& FunkyFilterAudioProcessor::getLoadMonitor()
+{
+    return loadMonitor;
+}
+
+//Parameter handles resolved at construction, so the editor can read settings without string lookups
+const FilterParameterHandles& FunkyFilterAudioProcessor::getParameterHandles() const
+{
+    return parameterHandles;
 }
 
 //==============================================================================
@@ -1,53 +1,119 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BiquadBank.h"
+#include "CoefficientTable.h"
+#include "EnvelopeFollower.h"
+#include "FilterDesign.h"
+#include "LfoShapeBank.h"
+#include "MultichannelBiquad.h"
+#include "MultichannelSVF.h"
+#include "ModulationTelemetry.h"
+#include "PresetBank.h"
+#include "ProcessLoadMonitor.h"
+#include "SpectrumAnalyser.h"
+
+//The render tool, the benchmarks and the checks set this and build without PluginEditor.cpp
+#ifndef FUNKYFILTER_HEADLESS
+ #define FUNKYFILTER_HEADLESS 0
+#endif
 
 //Data structure for parameters
 struct FilterSettings
 {
     float filterQuality{ 1.f }, minimumFrequency{ 0 }, maximumFrequency{ 0 }, bpm{ 120 }, lfoFreq{ 1 };
-    bool useNoteDuration{ false };
-    int noteDurationIndex{ 0 };
+    float bankSpread{ 2.f }, bankPhaseOffset{ 0.25f };
+    float envelopeMix{ 0 }, envelopeAttack{ 10.f }, envelopeRelease{ 200.f };
+    float stereoSpread{ 0 }; // Degrees
+    bool useNoteDuration{ false }, useTransportSync{ false }, useCoefficientTable{ false }, useStateVariableFilter{ false }, useFastMath{ false };
+    bool useRmsDetector{ false };
+    int noteDurationIndex{ 0 }, controlRateIndex{ 0 }, filterTypeIndex{ 0 }, lfoShapeIndex{ 0 }, bankVoices{ 1 };
 };
-using Coefficients = juce::dsp::IIR::Filter<float>::CoefficientsPtr;
 
 //=============================GLOBAL METHODS==================================
 
-// Retrieves values of parameters from the parameter tree and returns them as a FilterSettings structure.
-// This function creates a wrapper around parameters for cleaner and more organized code.
-inline FilterSettings getFilterSettings(juce::AudioProcessorValueTreeState& tree)
+//Handles to the raw parameter values, looked up once so reading them afterwards costs only atomic loads
+struct FilterParameterHandles
 {
-    FilterSettings settings;
+    std::atomic<float>* lfoFreq{ nullptr }, * noteDuration{ nullptr }, * bpm{ nullptr }, * useNoteDuration{ nullptr },
+        * filterQuality{ nullptr }, * minimumFrequency{ nullptr }, * maximumFrequency{ nullptr }, * controlRate{ nullptr },
+        * coefficientTable{ nullptr }, * filterEngine{ nullptr }, * filterType{ nullptr }, * lfoShape{ nullptr },
+        * bankVoices{ nullptr }, * bankSpread{ nullptr }, * bankPhaseOffset{ nullptr }, * transportSync{ nullptr },
+        * fastMath{ nullptr }, * oversampling{ nullptr }, * offlineOversampling{ nullptr }, * oversamplingFilter{ nullptr },
+        * envelopeMix{ nullptr }, * envelopeAttack{ nullptr }, * envelopeRelease{ nullptr }, * envelopeDetector{ nullptr },
+        * stereoSpread{ nullptr };
+};
 
-    settings.lfoFreq = tree.getRawParameterValue("FilterFrequency")->load();
-    settings.noteDurationIndex = tree.getRawParameterValue("NoteDuration")->load();
-    settings.bpm = tree.getRawParameterValue("BPM")->load();
-    settings.useNoteDuration = tree.getRawParameterValue("UseNoteDuration")->load() > 0.5f;
-    settings.filterQuality = tree.getRawParameterValue("FilterQuality")->load();
-    settings.minimumFrequency = tree.getRawParameterValue("MinimumFrequency")->load();
-    settings.maximumFrequency = tree.getRawParameterValue("MaximumFrequency")->load();
+// Resolves the parameter handles from the parameter tree. This does string-keyed lookups, so call it once, not per block.
+inline FilterParameterHandles getFilterParameterHandles(juce::AudioProcessorValueTreeState& tree)
+{
+    FilterParameterHandles handles;
 
-    return settings;
-}
+    handles.lfoFreq = tree.getRawParameterValue("FilterFrequency");
+    handles.noteDuration = tree.getRawParameterValue("NoteDuration");
+    handles.bpm = tree.getRawParameterValue("BPM");
+    handles.useNoteDuration = tree.getRawParameterValue("UseNoteDuration");
+    handles.filterQuality = tree.getRawParameterValue("FilterQuality");
+    handles.minimumFrequency = tree.getRawParameterValue("MinimumFrequency");
+    handles.maximumFrequency = tree.getRawParameterValue("MaximumFrequency");
+    handles.controlRate = tree.getRawParameterValue("ControlRate");
+    handles.coefficientTable = tree.getRawParameterValue("CoefficientTable");
+    handles.filterEngine = tree.getRawParameterValue("FilterEngine");
+    handles.filterType = tree.getRawParameterValue("FilterType");
+    handles.lfoShape = tree.getRawParameterValue("LfoShape");
+    handles.bankVoices = tree.getRawParameterValue("BankVoices");
+    handles.bankSpread = tree.getRawParameterValue("BankSpread");
+    handles.bankPhaseOffset = tree.getRawParameterValue("BankPhaseOffset");
+    handles.transportSync = tree.getRawParameterValue("TransportSync");
+    handles.fastMath = tree.getRawParameterValue("FastMath");
+    handles.oversampling = tree.getRawParameterValue("Oversampling");
+    handles.offlineOversampling = tree.getRawParameterValue("OfflineOversampling");
+    handles.oversamplingFilter = tree.getRawParameterValue("OversamplingFilter");
+    handles.envelopeMix = tree.getRawParameterValue("EnvelopeMix");
+    handles.envelopeAttack = tree.getRawParameterValue("EnvelopeAttack");
+    handles.envelopeRelease = tree.getRawParameterValue("EnvelopeRelease");
+    handles.envelopeDetector = tree.getRawParameterValue("EnvelopeDetector");
+    handles.stereoSpread = tree.getRawParameterValue("StereoSpread");
 
-//Creates coefficients for a band-pass filter using the specified filter frequency, filter quality (Q factor), and sample rate
-inline Coefficients makeBandPassFilter(double filterFrequency, float filterQuality, double sampleRate)
-{
-    return juce::dsp::IIR::Coefficients<float>::makeBandPass(
-        sampleRate,
-        filterFrequency,
-        filterQuality
-    );
+    return handles;
 }
 
-//Updates the existing filter coefficients with new coefficients
-inline void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+// Retrieves values of parameters through the cached handles and returns them as a FilterSettings structure.
+// This function creates a wrapper around parameters for cleaner and more organized code.
+inline FilterSettings getFilterSettings(const FilterParameterHandles& handles)
 {
-    *old = *replacements;
+    FilterSettings settings;
+
+    settings.lfoFreq = handles.lfoFreq->load();
+    settings.noteDurationIndex = handles.noteDuration->load();
+    settings.bpm = handles.bpm->load();
+    settings.useNoteDuration = handles.useNoteDuration->load() > 0.5f;
+    settings.filterQuality = handles.filterQuality->load();
+    settings.minimumFrequency = handles.minimumFrequency->load();
+    settings.maximumFrequency = handles.maximumFrequency->load();
+    settings.controlRateIndex = handles.controlRate->load();
+    settings.useCoefficientTable = handles.coefficientTable->load() > 0.5f;
+    settings.useStateVariableFilter = handles.filterEngine->load() > 0.5f;
+    settings.filterTypeIndex = handles.filterType->load();
+    settings.lfoShapeIndex = handles.lfoShape->load();
+    settings.bankVoices = (int)handles.bankVoices->load() + 1; // The first choice ("Off") is the single band
+    settings.bankSpread = handles.bankSpread->load();
+    settings.bankPhaseOffset = handles.bankPhaseOffset->load();
+    settings.useTransportSync = handles.transportSync->load() > 0.5f;
+    settings.useFastMath = handles.fastMath->load() > 0.5f;
+    settings.envelopeMix = handles.envelopeMix->load();
+    settings.envelopeAttack = handles.envelopeAttack->load();
+    settings.envelopeRelease = handles.envelopeRelease->load();
+    settings.useRmsDetector = handles.envelopeDetector->load() > 0.5f;
+    settings.stereoSpread = handles.stereoSpread->load();
+
+    return settings;
 }
 
 //==============================================================================
-class FunkyFilterAudioProcessor  : public juce::AudioProcessor
+class FunkyFilterAudioProcessor  : public juce::AudioProcessor,
+                                   private juce::AudioProcessorValueTreeState::Listener,
+                                   private juce::Timer
 {
 public:
     //==============================================================================
@@ -63,6 +129,12 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
+    // Largest bus the processor accepts (e.g. 7.1.4 is 12 channels, 3rd order ambisonics 16)
+    static constexpr int maximumNumChannels = 64;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -93,20 +165,194 @@ public:
     juce::AudioProcessorValueTreeState tree {*this, nullptr, "Parameters", createParameterLayout()};
 
     //==============================================================================
-    void initiateWavetable();
     double getCurrentFilterFrequency() const;
+    double getFilterSampleRate() const;
+    double getCurrentVoiceFrequency(int voice) const;
+    ModulationTelemetry& getTelemetry();
+    SpectrumFifo& getSpectrumFifo();
+    ProcessLoadMonitor& getLoadMonitor();
+    const FilterParameterHandles& getParameterHandles() const;
 
 private:
     //==============================================================================
-    juce::dsp::IIR::Filter<float> filterRight, filterLeft;
-    juce::Array<float> wavetable;
-    double wavetableSize = 1024;
-    double phase = 0;
-    double increment;
-    double currentFilterFrequency = 1000.0;
+    //Bits of the parameter change mask, grouped by the derived state each change invalidates
+    enum ParameterChange : juce::uint32
+    {
+        modulationChanged = 1 << 0,
+        rangeChanged = 1 << 1,
+        qualityChanged = 1 << 2,
+        otherChanged = 1 << 3,
+        engineChanged = 1 << 4,
+        envelopeChanged = 1 << 5,
+        everythingChanged = 0xffffffff
+    };
+
+    FilterParameterHandles parameterHandles = getFilterParameterHandles(tree);
+    std::atomic<juce::uint32> changedParameters{ everythingChanged };
+    FilterSettings currentSettings;
+
+    //==============================================================================
+    double phase = 0;     // Position in the current LFO shape's table, from 0 to 1
+    double increment = 0; // Phase advance per sample
+    int cyclesPerTable = 1;
+
+    // Length of one LFO cycle in quarter notes, for each NoteDuration choice
+    static constexpr double noteDurations[] = { 4.0, 2.0, 1.0, 0.5, 0.25 };
+
+    // With TransportSync the phase is derived from the host's ppqPosition at every block start instead of accumulated.
+    // If the host's loop wraps within the block, the phase jumps to the loop start's at transportWrapSample.
+    int transportWrapSample = -1;
+    double transportWrapPhase = 0;
+    float currentPosition = 0;
+    std::atomic<double> currentFilterFrequency{ 1000.0 };
+    float logMinimumFrequency = 0, logFrequencyRange = 0;
+    int controlInterval = 1;
+
+    // Everything that runs at the processing precision: the filter engines and the targets they ramp towards.
+    // The state variable engine, selected by the FilterEngine parameter, ramps towards (g, k) instead of biquad coefficients.
+    // The band-pass bank, selected by the BankVoices parameter, takes precedence over both and ramps five terms per voice.
+    // The single band's targets hold the left side's set followed by the right side's, which only differ with
+    // StereoSpread. Only the set matching the host's precision is given any storage.
+    static constexpr int maximumBankVoices = BiquadBank<float>::maximumVoices;
+    static constexpr int numOversamplingFactors = 3, maximumOversamplingFactor = 8;
+
+    template <typename SampleType>
+    struct FilterEngines
+    {
+        MultichannelBiquad<SampleType> biquad;
+        MultichannelSVF<SampleType> stateVariable;
+        BiquadBank<SampleType> bank;
+        std::array<SampleType, 2 * 5> targetCoefficients{};
+        std::array<SampleType, 2 * 2> targetStateVariable{};
+        std::array<SampleType, 5 * maximumBankVoices> targetBank{};
+
+        // Where the targets stood when a restored state or preset arrived, faded out over crossfadeSamples
+        std::array<SampleType, 2 * 5> fadeCoefficients{};
+        std::array<SampleType, 2 * 2> fadeStateVariable{};
+        std::array<SampleType, 5 * maximumBankVoices> fadeBank{};
+
+        // Oversampling stages (see below), and the buffer the filter runs on while one of them is active
+        std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 2 * numOversamplingFactors> oversamplers;
+        juce::AudioBuffer<SampleType> oversampledBuffer;
+
+        // Follows the sidechain (or the main input without one) at the host's rate, ahead of any oversampling
+        EnvelopeFollower<SampleType> envelope;
+    };
+
+    FilterEngines<float> floatEngines;
+    FilterEngines<double> doubleEngines;
+    bool stateVariableFilterActive = false, bankActive = false;
+
+    // Bank voice v sweeps the main range shifted up by v / (voices - 1) of BankSpread octaves, BankPhaseOffset cycles behind voice v - 1
+    std::array<double, maximumBankVoices> bankFrequencyRatios{};
+    std::array<std::atomic<double>, maximumBankVoices> currentVoiceFrequencies{};
+    std::array<double, maximumBankVoices> voiceFrequencies{};
+
+    // With StereoSpread the right channels' LFO runs this far ahead of the left channels', in table phase. The right
+    // channels are those of the bus's left/right pairs (right, right surround, right top front...), found from its channel
+    // types in prepareToPlay; every other channel, including all of an ambisonic or discrete layout, follows the left
+    // side's. The bank already spreads its voices with BankPhaseOffset, and stays the same on every channel.
+    double stereoPhaseOffset = 0;
+    bool hasStereoPairs = false;
+
+    // Optional precomputed coefficients, fetched in the background whenever the frequency range or sample rate changes.
+    // The tables and the thread that builds them are shared by every instance in the process.
+    juce::SharedResourcePointer<SharedCoefficientTables> sharedCoefficientTables;
+    CoefficientTableCache coefficientTableCache{ sharedCoefficientTables.getObject() };
+    const CoefficientTable* coefficientTable = nullptr;
+    CoefficientTable::QualityPoint qualityPoint;
+
+    // Modulation records for the editor, gathered per step and measured once the block has been filtered
+    struct PendingTelemetryStep
+    {
+        int startSample, numSamples;
+        float position, phase;
+    };
+
+    static constexpr int minimumTelemetryStep = 32;
+    ModulationTelemetry telemetry;
+    std::vector<PendingTelemetryStep> pendingSteps;
+
+    // Silence detection: once the input has been silent for longer than the filter rings (tailSamples, for the lowest
+    // cutoff of the sweep and the current Q), filtering is skipped and the state is flushed
+    static constexpr float silenceThreshold = 1.0e-6f;  // -120 dBFS
+    static constexpr double tailDecibels = 120.0;
+    int tailSamples = 0, silentSamples = 0;
+    bool filterFlushed = true;
+
+    // Output samples for the editor's spectrum analyser
+    SpectrumFifo spectrumFifo;
+
+    // Time each processBlock takes against its real-time budget
+    ProcessLoadMonitor loadMonitor;
+
+    // Session state and presets are restored from the host's threads by writing every parameter, then publishing the
+    // complete FilterSettings they produce to a preallocated snapshot. restoreGeneration works like a seqlock: it's odd
+    // while a restore is writing, and the audio thread discards any read of the parameters it overlapped, so it never
+    // sees half of one state and half of another; the snapshot then swaps in whole and the coefficients crossfade from
+    // where they were over crossfadeSeconds. stateLock is never taken by the audio thread.
+    // The programs are the bank's presets as they were when this instance was created, since hosts cache their number.
+    juce::SharedResourcePointer<SharedPresetBank> presetBank;
+    const std::shared_ptr<const std::vector<Preset>> programs = presetBank->getPresets();
+    std::array<juce::RangedAudioParameter*, PresetState::numParameters> stateParameters{};
+    juce::CriticalSection stateLock;
+    TripleBuffer<FilterSettings> restoredSettings;
+    std::atomic<juce::uint32> restoreGeneration{ 0 };
+    std::atomic<int> currentProgram{ 0 };
+
+    static constexpr double crossfadeSeconds = 0.02;
+    int crossfadeSamples = 1, crossfadeRemaining = 0;
+
+    // Optional oversampling around the filter: 2x, 4x or 8x, with the Oversampling choice while playing in real time and
+    // OfflineOversampling while the host renders offline, through half-band polyphase IIR (the first three stages) or
+    // linear phase FIR filters (the last three). Every stage is built by prepareToPlay, so the audio thread switches
+    // between them without allocating. A changed choice only raises latencyChanged, since automation can change it on
+    // the audio thread; the timer tells the host the new latency from the message thread.
+    // Everything downstream of the oversampler (LFO increment, control interval, tail, crossfade) runs at filterSampleRate.
+    std::array<std::atomic<int>, 2 * numOversamplingFactors> oversamplingLatencies{};
+    std::atomic<bool> latencyChanged{ false };
+    int activeOversamplingStage = -1, oversamplingFactor = 1;
+    double filterSampleRate = 44100.0;
+    std::atomic<double> currentFilterSampleRate{ 0.0 };
+
+    // The envelope follower is a second modulation source: with EnvelopeMix above 0 every LFO position is blended
+    // towards the envelope's, read at the end of each control segment. modulationSample counts the filter-rate samples
+    // advanced in the current block, to find that point in the host-rate envelope. followingEnvelope is whether the last
+    // block was followed, so the follower starts afresh when the envelope is blended in again.
+    int modulationSample = 0;
+    bool followingEnvelope = false;
 
     //==============================================================================
-    void updateFilter(const FilterSettings& filterSettings, double sampleRate, int blockSize);
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void updateFilter(const FilterSettings& filterSettings, double sampleRate, juce::uint32 changes);
+    void syncToTransport(const juce::AudioPlayHead::PositionInfo& position, const FilterSettings& filterSettings,
+                         double sampleRate, int numSamples);
+    void flushFilter();
+    void applyState(const PresetState::Values& values);
+    int getOversamplingStage() const noexcept;
+    static juce::BigInteger getRightChannels(const juce::AudioChannelSet& layout);
+    void updateLatency();
+    void timerCallback() override;
+
+    // Shared by the float and double paths, defined in PluginProcessor.cpp
+    template <typename SampleType> FilterEngines<SampleType>& getEngines() noexcept;
+    template <typename SampleType> void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType> void processAtFilterRate(juce::AudioBuffer<SampleType>& buffer, int numChannels);
+    template <typename SampleType> void followEnvelope(const juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept;
+    template <typename SampleType> void prepareOversampling(int numChannels, int samplesPerBlock);
+    template <typename SampleType> void selectOversampling(int stage);
+    template <typename SampleType> void resetFilter(const FilterSettings& filterSettings, double sampleRate);
+    template <typename SampleType> void advanceModulation(const FilterSettings& filterSettings, double sampleRate, int numSamples);
+    template <typename SampleType> void processFilter(juce::AudioBuffer<SampleType>& buffer, const FilterSettings& filterSettings, bool inputSilent);
+    template <typename SampleType> void pushTelemetry(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numPendingSteps);
+    template <typename SampleType> void startCrossfade() noexcept;
+    template <typename SampleType> void applyCrossfade(int numSamples) noexcept;
+    template <typename SampleType> bool skipSilentBlock(bool inputSilent, const FilterSettings& filterSettings, double sampleRate, int numSamples);
+    template <typename SampleType> static bool isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels);
+    void publishFilterFrequencies(int numVoices) noexcept;
+    float getFrequencyForPosition(float position, bool useFastMath = false) const noexcept;
+    template <typename SampleType> float getModulationPosition(const FilterSettings& filterSettings, float lfoPosition) noexcept;
+    double getCyclePhase() const noexcept;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FunkyFilterAudioProcessor)
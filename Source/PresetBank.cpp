@@ -0,0 +1,174 @@
+#include "PresetBank.h"
+
+//==============================================================================
+PresetState::Values PresetState::makeDefaultValues() noexcept
+{
+    Values values;
+    values.fill(std::numeric_limits<float>::quiet_NaN());
+    return values;
+}
+
+int PresetState::getParameterIndex(const juce::String& parameterID) noexcept
+{
+    for (int i = 0; i < numParameters; ++i)
+        if (parameterID == parameterIDs[i])
+            return i;
+
+    return -1;
+}
+
+void PresetState::write(const Values& values, juce::OutputStream& stream)
+{
+    stream.writeInt((int)tag);
+    stream.writeShort((short)formatVersion);
+    stream.writeShort((short)numParameters);
+
+    for (auto value : values)
+        stream.writeFloat(value);
+}
+
+bool PresetState::read(const void* data, size_t sizeInBytes, Values& values)
+{
+    constexpr size_t headerSize = 8;
+
+    juce::MemoryInputStream stream(data, sizeInBytes, false);
+
+    if (sizeInBytes < headerSize || (juce::uint32)stream.readInt() != tag)
+    {
+        // Earlier versions saved the parameter tree, each parameter a PARAM child with its id and plain value
+        const auto valueTree = juce::ValueTree::readFromData(data, sizeInBytes);
+
+        if (!valueTree.isValid())
+            return false;
+
+        for (const auto& child : valueTree)
+        {
+            const auto index = getParameterIndex(child.getProperty("id").toString());
+
+            if (index >= 0 && child.hasProperty("value"))
+                values[(size_t)index] = (float)child.getProperty("value");
+        }
+
+        return true;
+    }
+
+    const auto version = (int)(juce::uint16)stream.readShort();
+    const auto numValues = (int)(juce::uint16)stream.readShort();
+
+    if (version > formatVersion || sizeInBytes < headerSize + (size_t)numValues * sizeof(float))
+        return false;
+
+    // Values past the ones this version knows belong to parameters added later, and are skipped
+    for (int i = 0; i < numValues; ++i)
+    {
+        const auto value = stream.readFloat();
+
+        if (i < numParameters && std::isfinite(value))
+            values[(size_t)i] = value;
+    }
+
+    return true;
+}
+
+//==============================================================================
+//Builds a factory preset from the parameters it changes, everything else stays at its default
+static Preset makeFactoryPreset(const juce::String& name, std::initializer_list<std::pair<const char*, float>> parameters)
+{
+    Preset preset{ name, PresetState::makeDefaultValues() };
+
+    for (const auto& [parameterID, value] : parameters)
+    {
+        const auto index = PresetState::getParameterIndex(parameterID);
+        jassert(index >= 0);
+
+        if (index >= 0)
+            preset.values[(size_t)index] = value;
+    }
+
+    return preset;
+}
+
+SharedPresetBank::SharedPresetBank()
+{
+    factoryPresets = {
+        makeFactoryPreset("Default", {}),
+        makeFactoryPreset("Slow Sweep", { { "FilterFrequency", 0.2f }, { "FilterQuality", 2.f },
+                                          { "MinimumFrequency", 150.f }, { "MaximumFrequency", 6000.f } }),
+        makeFactoryPreset("Synced Wah", { { "UseNoteDuration", 1.f }, { "TransportSync", 1.f }, { "NoteDuration", 2.f },
+                                          { "LfoShape", 1.f }, { "FilterQuality", 4.f },
+                                          { "MinimumFrequency", 400.f }, { "MaximumFrequency", 2500.f } }),
+        makeFactoryPreset("Random Steps", { { "UseNoteDuration", 1.f }, { "TransportSync", 1.f }, { "NoteDuration", 3.f },
+                                            { "LfoShape", 4.f }, { "FilterQuality", 6.f }, { "ControlRate", 0.f } }),
+        makeFactoryPreset("Low Pass Pump", { { "UseNoteDuration", 1.f }, { "TransportSync", 1.f }, { "NoteDuration", 2.f },
+                                             { "LfoShape", 2.f }, { "FilterEngine", 1.f }, { "FilterType", 1.f },
+                                             { "FilterQuality", 0.9f }, { "MinimumFrequency", 200.f }, { "MaximumFrequency", 8000.f } }),
+        makeFactoryPreset("Vowel Bank", { { "BankVoices", 3.f }, { "BankSpread", 1.5f }, { "BankPhaseOffset", 0.33f },
+                                          { "FilterFrequency", 0.5f }, { "FilterQuality", 5.f },
+                                          { "MinimumFrequency", 250.f }, { "MaximumFrequency", 1200.f } })
+    };
+
+    // The user's presets are read before the first processor can report its programs, since hosts only ask for the
+    // count once. It's a folder of files of about a hundred bytes each, read once per process.
+    scanUserPresets();
+
+    thread.addTimeSliceClient(this);
+    thread.startThread();
+}
+
+SharedPresetBank::~SharedPresetBank()
+{
+    thread.removeTimeSliceClient(this);
+    thread.stopThread(1000);
+}
+
+juce::File SharedPresetBank::getUserPresetFolder()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("FunkyFilter")
+        .getChildFile("Presets");
+}
+
+std::shared_ptr<const std::vector<Preset>> SharedPresetBank::getPresets() const
+{
+    const juce::SpinLock::ScopedLockType lock(presetsLock);
+    return presets;
+}
+
+void SharedPresetBank::rescan()
+{
+    rescanRequested.store(true);
+    thread.moveToFrontOfQueue(this);
+}
+
+int SharedPresetBank::useTimeSlice()
+{
+    if (rescanRequested.exchange(false))
+        scanUserPresets();
+
+    return 500;
+}
+
+void SharedPresetBank::scanUserPresets()
+{
+    auto newPresets = std::make_shared<std::vector<Preset>>(factoryPresets);
+    auto files = getUserPresetFolder().findChildFiles(juce::File::findFiles, false, juce::String("*") + fileExtension);
+    files.sort();
+
+    for (const auto& file : files)
+    {
+        juce::MemoryBlock data;
+        Preset preset{ file.getFileNameWithoutExtension(), PresetState::makeDefaultValues() };
+
+        // Files that aren't a state, or come from a newer version, are left out
+        if (file.loadFileAsData(data) && PresetState::read(data.getData(), data.getSize(), preset.values))
+            newPresets->push_back(std::move(preset));
+    }
+
+    // Swapped so the previous list is released outside the lock
+    std::shared_ptr<const std::vector<Preset>> published = std::move(newPresets);
+
+    {
+        const juce::SpinLock::ScopedLockType lock(presetsLock);
+        std::swap(presets, published);
+    }
+}
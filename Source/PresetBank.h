@@ -0,0 +1,72 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Compact, versioned binary form of the plugin state, used for the host's session state as well as preset files:
+//a four byte tag, the format version, the number of values, then each parameter's plain value as a 32 bit float,
+//all little-endian, so a whole state is an eight byte header and four bytes per parameter.
+//Values are stored in the order of parameterIDs. New parameters are only ever appended to it, never reordered or
+//removed, so a state saved before a parameter existed simply holds fewer values and that parameter keeps its default.
+struct PresetState
+{
+    static constexpr const char* parameterIDs[] = {
+        "FilterFrequency", "FilterQuality", "MinimumFrequency", "MaximumFrequency", "UseNoteDuration", "TransportSync",
+        "BPM", "NoteDuration", "ControlRate", "CoefficientTable", "FilterEngine", "FilterType", "LfoShape",
+        "BankVoices", "BankSpread", "BankPhaseOffset", "FastMath", "Oversampling", "OfflineOversampling",
+        "OversamplingFilter", "EnvelopeMix", "EnvelopeAttack", "EnvelopeRelease", "EnvelopeDetector",
+        "StereoSpread"
+    };
+
+    static constexpr int numParameters = (int)std::size(parameterIDs);
+    static constexpr int formatVersion = 1;
+    static constexpr juce::uint32 tag = 0x54534646; // "FFST"
+
+    //Plain (not normalised) values in parameterIDs order, NaN where a state leaves the parameter at its default
+    using Values = std::array<float, numParameters>;
+
+    static Values makeDefaultValues() noexcept;
+    static int getParameterIndex(const juce::String& parameterID) noexcept;
+
+    static void write(const Values& values, juce::OutputStream& stream);
+
+    //Also accepts the ValueTree that earlier versions saved. Returns false if the data is neither, or from a newer format.
+    static bool read(const void* data, size_t sizeInBytes, Values& values);
+};
+
+struct Preset
+{
+    juce::String name;
+    PresetState::Values values;
+};
+
+//Process-wide preset bank, held through juce::SharedResourcePointer like the coefficient tables, so presets are loaded
+//and parsed once however many instances are open. The factory presets are built in; the user's are the preset files in
+//getUserPresetFolder() (any saved state works as one), read on the bank's own thread. The list is immutable once
+//published, so recalling a preset only copies its values.
+class SharedPresetBank : private juce::TimeSliceClient
+{
+public:
+    SharedPresetBank();
+    ~SharedPresetBank() override;
+
+    static juce::File getUserPresetFolder();
+    static constexpr const char* fileExtension = ".ffpreset";
+
+    //Any thread but the audio thread: factory presets first, then the user's in alphabetical order
+    std::shared_ptr<const std::vector<Preset>> getPresets() const;
+
+    //Reads the user preset folder again, in the background. Processors that already exist keep the list they started
+    //with, since hosts cache the number of programs; instances created afterwards see the new one.
+    void rescan();
+
+private:
+    int useTimeSlice() override;
+    void scanUserPresets();
+
+    juce::TimeSliceThread thread{ "FunkyFilter Presets" };
+    std::vector<Preset> factoryPresets;
+    std::atomic<bool> rescanRequested{ false };
+
+    mutable juce::SpinLock presetsLock;
+    std::shared_ptr<const std::vector<Preset>> presets;
+};
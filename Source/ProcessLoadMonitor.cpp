@@ -0,0 +1,190 @@
+#include "ProcessLoadMonitor.h"
+
+//==============================================================================
+//Drains the trace queue into a CSV file every few milliseconds, on its own thread so file I/O never
+//touches the audio or message thread. It only exists while a trace is running.
+class ProcessLoadMonitor::TraceWriter : private juce::TimeSliceClient
+{
+public:
+    TraceWriter(ProcessLoadMonitor& monitorToDrain, std::unique_ptr<juce::FileOutputStream> outputStream)
+        : monitor(monitorToDrain), stream(std::move(outputStream))
+    {
+        // Records left over from an earlier trace belong to that one
+        monitor.traceFifo.read(monitor.traceFifo.getNumReady());
+
+        stream->writeText("time_seconds,num_samples,block_seconds,budget_proportion\n", false, false, nullptr);
+
+        thread.addTimeSliceClient(this);
+        thread.startThread();
+    }
+
+    ~TraceWriter() override
+    {
+        thread.removeTimeSliceClient(this);
+        thread.stopThread(1000);
+
+        // Whatever was queued before the trace stopped still goes in
+        drain();
+        stream->flush();
+    }
+
+private:
+    int useTimeSlice() override
+    {
+        drain();
+        return 50;
+    }
+
+    void drain()
+    {
+        const auto scope = monitor.traceFifo.read(monitor.traceFifo.getNumReady());
+
+        for (auto i = scope.startIndex1; i < scope.startIndex1 + scope.blockSize1; ++i)
+            write(monitor.traceRecords[(size_t)i]);
+
+        for (auto i = scope.startIndex2; i < scope.startIndex2 + scope.blockSize2; ++i)
+            write(monitor.traceRecords[(size_t)i]);
+    }
+
+    void write(const TraceRecord& record)
+    {
+        if (firstTicks < 0)
+            firstTicks = record.startTicks;
+
+        const auto time = juce::Time::highResolutionTicksToSeconds(record.startTicks - firstTicks);
+
+        stream->writeText(juce::String(time, 6) + "," + juce::String(record.numSamples) + ","
+                              + juce::String(record.seconds, 9) + "," + juce::String(record.load, 4) + "\n",
+                          false, false, nullptr);
+    }
+
+    ProcessLoadMonitor& monitor;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::TimeSliceThread thread{ "FunkyFilter Load Trace" };
+    juce::int64 firstTicks = -1;
+};
+
+//==============================================================================
+ProcessLoadMonitor::ProcessLoadMonitor()
+{
+}
+
+ProcessLoadMonitor::~ProcessLoadMonitor()
+{
+    stopTrace();
+}
+
+void ProcessLoadMonitor::prepare(double newSampleRate, int maximumBlockSize)
+{
+    loadMeasurer.reset(newSampleRate, maximumBlockSize);
+    sampleRate.store(newSampleRate);
+
+    for (auto& bin : histogram)
+        bin.store(0, std::memory_order_relaxed);
+
+    numBlocks.store(0);
+    nearOverruns.store(0);
+    overruns.store(0);
+    worstBlockLoad.store(0);
+    worstBlockSeconds.store(0);
+}
+
+void ProcessLoadMonitor::record(juce::int64 startTicks, juce::int64 endTicks, int numSamples) noexcept
+{
+    const auto rate = sampleRate.load(std::memory_order_relaxed);
+
+    if (numSamples <= 0 || rate <= 0)
+        return;
+
+    const auto seconds = juce::Time::highResolutionTicksToSeconds(endTicks - startTicks);
+    const auto load = seconds * rate / numSamples;
+
+    loadMeasurer.registerRenderTime(seconds * 1000.0, numSamples);
+
+    // Only the audio thread writes these, so plain load-then-store updates are enough
+    const auto bin = juce::jlimit(0, numHistogramBins - 1, (int)(load * 100.0));
+    histogram[(size_t)bin].store(histogram[(size_t)bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    numBlocks.store(numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (load > nearOverrunLoad)
+        nearOverruns.store(nearOverruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (load > 1.0)
+        overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (load > worstBlockLoad.load(std::memory_order_relaxed))
+    {
+        worstBlockLoad.store(load, std::memory_order_relaxed);
+        worstBlockSeconds.store(seconds, std::memory_order_relaxed);
+    }
+
+    if (tracing.load(std::memory_order_relaxed))
+    {
+        // If the writer falls behind, blocks are left out of the trace rather than ever waiting for it
+        const auto scope = traceFifo.write(1);
+
+        if (scope.blockSize1 > 0)
+            traceRecords[(size_t)scope.startIndex1] = { startTicks, numSamples, seconds, load };
+    }
+}
+
+//==============================================================================
+ProcessLoadStatistics ProcessLoadMonitor::getStatistics() const
+{
+    ProcessLoadStatistics statistics;
+
+    statistics.load = loadMeasurer.getLoadAsProportion();
+    statistics.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    statistics.nearOverruns = nearOverruns.load(std::memory_order_relaxed);
+    statistics.overruns = overruns.load(std::memory_order_relaxed);
+    statistics.worstBlockLoad = worstBlockLoad.load(std::memory_order_relaxed);
+    statistics.worstBlockSeconds = worstBlockSeconds.load(std::memory_order_relaxed);
+
+    // Percentiles are read off the histogram at the upper edge of the bin they fall in
+    std::array<juce::uint32, numHistogramBins> counts;
+    juce::int64 total = 0;
+
+    for (size_t bin = 0; bin < counts.size(); ++bin)
+        total += counts[bin] = histogram[bin].load(std::memory_order_relaxed);
+
+    const auto getPercentile = [&counts, total](double percentile)
+    {
+        const auto target = (juce::int64)std::ceil(percentile * (double)total);
+        juce::int64 seen = 0;
+
+        for (size_t bin = 0; bin < counts.size(); ++bin)
+            if ((seen += counts[bin]) >= target)
+                return (double)(bin + 1) / 100.0;
+
+        return (double)numHistogramBins / 100.0;
+    };
+
+    if (total > 0)
+    {
+        statistics.medianBlockLoad = getPercentile(0.5);
+        statistics.p99BlockLoad = getPercentile(0.99);
+    }
+
+    return statistics;
+}
+
+bool ProcessLoadMonitor::startTrace(const juce::File& file)
+{
+    stopTrace();
+
+    file.deleteFile();
+    auto stream = file.createOutputStream();
+
+    if (stream == nullptr)
+        return false;
+
+    traceWriter = std::make_unique<TraceWriter>(*this, std::move(stream));
+    tracing.store(true);
+    return true;
+}
+
+void ProcessLoadMonitor::stopTrace()
+{
+    tracing.store(false);
+    traceWriter.reset();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Snapshot of how much of the real-time budget (block size / sample rate) processBlock has been using.
+//All loads are proportions of the budget, so 1 means a block took exactly as long as it lasts.
+struct ProcessLoadStatistics
+{
+    double load = 0;                                                  // Smoothed, from juce::AudioProcessLoadMeasurer
+    double medianBlockLoad = 0, p99BlockLoad = 0, worstBlockLoad = 0; // From the per-block histogram
+    double worstBlockSeconds = 0;
+    juce::int64 numBlocks = 0, nearOverruns = 0, overruns = 0;
+};
+
+//Per-instance CPU load instrumentation. The audio thread times each block into a juce::AudioProcessLoadMeasurer and a
+//lock-free histogram of per-block loads (relaxed atomic counters, one writer), so any thread can read percentiles,
+//the worst block and how many blocks came close to or over the budget without ever blocking the audio thread.
+//Optionally every block's timing is also queued to a trace file, written as CSV on a background thread.
+class ProcessLoadMonitor
+{
+public:
+    static constexpr int numHistogramBins = 200;         // 1% of the budget each, the last one also counts anything slower
+    static constexpr double nearOverrunLoad = 0.7;       // Blocks above this are counted as at risk of an xrun
+    static constexpr int traceCapacity = 1 << 14;
+
+    ProcessLoadMonitor();
+    ~ProcessLoadMonitor();
+
+    //Called from prepareToPlay, also clears the statistics
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    //Audio thread, times the enclosing scope as one block of numSamples
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(ProcessLoadMonitor& monitorToUse, int numSamplesInBlock) noexcept
+            : monitor(monitorToUse), numSamples(numSamplesInBlock), startTicks(juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedTimer() { monitor.record(startTicks, juce::Time::getHighResolutionTicks(), numSamples); }
+
+    private:
+        ProcessLoadMonitor& monitor;
+        const int numSamples;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    //Any thread
+    ProcessLoadStatistics getStatistics() const;
+
+    //Message thread, the trace holds one CSV row per block until stopped
+    bool startTrace(const juce::File& file);
+    void stopTrace();
+    bool isTracing() const noexcept { return tracing.load(std::memory_order_relaxed); }
+
+private:
+    void record(juce::int64 startTicks, juce::int64 endTicks, int numSamples) noexcept;
+
+    juce::AudioProcessLoadMeasurer loadMeasurer;
+    std::atomic<double> sampleRate{ 0 };
+
+    std::array<std::atomic<juce::uint32>, numHistogramBins> histogram{};
+    std::atomic<juce::int64> numBlocks{ 0 }, nearOverruns{ 0 }, overruns{ 0 };
+    std::atomic<double> worstBlockLoad{ 0 }, worstBlockSeconds{ 0 };
+
+    // Blocks waiting to be written to the trace file
+    struct TraceRecord
+    {
+        juce::int64 startTicks;
+        int numSamples;
+        double seconds, load;
+    };
+
+    class TraceWriter;
+
+    juce::AbstractFifo traceFifo{ traceCapacity };
+    std::array<TraceRecord, traceCapacity> traceRecords{};
+    std::atomic<bool> tracing{ false };
+    std::unique_ptr<TraceWriter> traceWriter;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessLoadMonitor)
+};
@@ -0,0 +1,102 @@
+#include "SpectrumAnalyser.h"
+
+SpectrumAnalyser::SpectrumAnalyser(SpectrumFifo& s) : juce::Thread("FunkyFilter Spectrum Analyser"), source(s)
+{
+    smoothedDecibels.fill(minimumDecibels);
+
+    source.setEnabled(true);
+    startThread();
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    source.setEnabled(false);
+    stopThread(1000);
+}
+
+void SpectrumAnalyser::setBounds(int width, int height) noexcept
+{
+    pathWidth.store(width);
+    pathHeight.store(height);
+}
+
+void SpectrumAnalyser::setSampleRate(double sampleRate) noexcept
+{
+    if (sampleRate > 0)
+        pathSampleRate.store(sampleRate);
+}
+
+void SpectrumAnalyser::run()
+{
+    while (!threadShouldExit())
+    {
+        if (source.getNumReady() < hopSize)
+        {
+            wait(10);
+            continue;
+        }
+
+        // Slide the history along by one hop and append the newest samples
+        std::copy(history.begin() + hopSize, history.end(), history.begin());
+        source.pop(history.data() + fftSize - hopSize, hopSize);
+
+        analyseFrame();
+    }
+}
+
+//Windows and transforms the current history, then folds the new levels into the smoothed spectrum
+void SpectrumAnalyser::analyseFrame()
+{
+    std::copy(history.begin(), history.end(), fftData.begin());
+    window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // With a normalised window, a full scale sine lands at fftSize / 2
+    constexpr auto scale = 2.f / fftSize;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const auto level = juce::Decibels::gainToDecibels(fftData[(size_t)bin] * scale, minimumDecibels);
+        auto& smoothed = smoothedDecibels[(size_t)bin];
+
+        // Rise immediately, fall back slowly so the display doesn't flicker
+        smoothed = level > smoothed ? level : smoothed + 0.2f * (level - smoothed);
+    }
+
+    buildPath(paths.getWriteBuffer());
+    paths.publish();
+}
+
+//Bins the smoothed spectrum onto the same logarithmic 20 Hz - 20 kHz axis as the response curve.
+//Each pixel shows the loudest bin it covers, so narrow peaks at high frequencies aren't lost.
+void SpectrumAnalyser::buildPath(juce::Path& path)
+{
+    const auto width = pathWidth.load();
+    const auto height = (float)pathHeight.load();
+    const auto binsPerHertz = fftSize / pathSampleRate.load();
+
+    path.clear();
+
+    if (width <= 0)
+        return;
+
+    path.preallocateSpace(3 * (width + 3));
+    path.startNewSubPath(0.f, height);
+
+    auto lowerBin = juce::mapToLog10(0.0, 20.0, 20000.0) * binsPerHertz;
+
+    for (int x = 0; x < width; ++x)
+    {
+        const auto upperBin = juce::mapToLog10(double(x + 1) / double(width), 20.0, 20000.0) * binsPerHertz;
+        const auto first = juce::jlimit(0, numBins - 1, (int)lowerBin);
+        const auto last = juce::jlimit(first + 1, numBins, (int)std::ceil(upperBin));
+
+        const auto decibels = *std::max_element(smoothedDecibels.begin() + first, smoothedDecibels.begin() + last);
+        path.lineTo((float)x, juce::jmap(decibels, minimumDecibels, 0.f, height, 0.f));
+
+        lowerBin = upperBin;
+    }
+
+    path.lineTo((float)width, height);
+    path.closeSubPath();
+}
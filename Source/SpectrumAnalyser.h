@@ -0,0 +1,120 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+//Lock-free single-producer/single-consumer queue of output samples (mixed to mono) for the spectrum analyser.
+//The audio thread only copies into preallocated storage; if the analyser falls behind, samples are dropped
+//instead of ever making the audio thread wait.
+class SpectrumFifo
+{
+public:
+    static constexpr int capacity = 1 << 14;
+
+    //The audio thread only queues samples while an analyser is running
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    //Audio thread, double-precision output is narrowed to float on the way in
+    template <typename SampleType>
+    void push(const juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
+    {
+        if (numChannels <= 0)
+            return;
+
+        const auto scope = fifo.write(juce::jmin(buffer.getNumSamples(), fifo.getFreeSpace()));
+        const auto gain = 1.f / (float)numChannels;
+
+        mixToMono(buffer, numChannels, gain, 0, scope.startIndex1, scope.blockSize1);
+        mixToMono(buffer, numChannels, gain, scope.blockSize1, scope.startIndex2, scope.blockSize2);
+    }
+
+    //Analyser thread
+    int getNumReady() const noexcept { return fifo.getNumReady(); }
+
+    int pop(float* destination, int numSamples) noexcept
+    {
+        const auto scope = fifo.read(juce::jmin(numSamples, fifo.getNumReady()));
+
+        std::copy_n(samples.data() + scope.startIndex1, scope.blockSize1, destination);
+        std::copy_n(samples.data() + scope.startIndex2, scope.blockSize2, destination + scope.blockSize1);
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+private:
+    template <typename SampleType>
+    void mixToMono(const juce::AudioBuffer<SampleType>& buffer, int numChannels, float gain, int bufferStart, int fifoStart, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        auto* destination = samples.data() + fifoStart;
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::FloatVectorOperations::copyWithMultiply(destination, buffer.getReadPointer(0, bufferStart), gain, numSamples);
+
+            for (int channel = 1; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(channel, bufferStart), gain, numSamples);
+        }
+        else
+        {
+            std::fill_n(destination, numSamples, 0.f);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto* source = buffer.getReadPointer(channel, bufferStart);
+
+                for (int i = 0; i < numSamples; ++i)
+                    destination[i] += gain * (float)source[i];
+            }
+        }
+    }
+
+    juce::AbstractFifo fifo{ capacity };
+    std::array<float, capacity> samples{};
+    std::atomic<bool> enabled{ false };
+};
+
+//Turns the samples queued in a SpectrumFifo into a ready-to-draw spectrum path on its own thread.
+//Windowing, the FFT, smoothing and log-frequency binning all happen here, so the message thread only
+//picks up the newest path and fills it. The analyser enables the FIFO while it exists, so nothing is
+//gathered or computed while no editor is open.
+class SpectrumAnalyser : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 11, fftSize = 1 << fftOrder, hopSize = fftSize / 4, numBins = fftSize / 2 + 1;
+    static constexpr float minimumDecibels = -96.f;
+
+    SpectrumAnalyser(SpectrumFifo& source);
+    ~SpectrumAnalyser() override;
+
+    //Message thread, the path is built for an area of this size at this sample rate
+    void setBounds(int width, int height) noexcept;
+    void setSampleRate(double sampleRate) noexcept;
+
+    //Message thread, returns true if a newer path is ready, which getPath() then returns until the next call
+    bool acquirePath() noexcept { return paths.acquire(); }
+    const juce::Path& getPath() const noexcept { return paths.getReadBuffer(); }
+
+private:
+    void run() override;
+    void analyseFrame();
+    void buildPath(juce::Path& path);
+
+    SpectrumFifo& source;
+
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann };
+
+    // The last fftSize samples, the FFT's working buffer (twice the size for the in-place transform)
+    // and the smoothed level of every bin in decibels
+    std::array<float, fftSize> history{};
+    std::array<float, fftSize * 2> fftData{};
+    std::array<float, numBins> smoothedDecibels{};
+
+    std::atomic<int> pathWidth{ 0 }, pathHeight{ 0 };
+    std::atomic<double> pathSampleRate{ 44100.0 };
+    TripleBuffer<juce::Path> paths;
+};
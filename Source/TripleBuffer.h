@@ -0,0 +1,42 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//Lock-free single-producer/single-consumer triple buffer.
+//The writer fills getWriteBuffer() and calls publish(); the reader calls acquire() to pick up the newest
+//published value and then reads getReadBuffer(). Neither side ever waits on the other, and the writer never
+//touches the buffer the reader is currently holding.
+template <typename Type>
+class TripleBuffer
+{
+public:
+    //==============================================================================
+    //Writer side
+    Type& getWriteBuffer() noexcept { return buffers[writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = shared.exchange(writeIndex | newDataBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //==============================================================================
+    //Reader side, returns true if a newer value was swapped in
+    bool acquire() noexcept
+    {
+        if ((shared.load(std::memory_order_relaxed) & newDataBit) == 0)
+            return false;
+
+        readIndex = shared.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const Type& getReadBuffer() const noexcept { return buffers[readIndex]; }
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3, newDataBit = 4;
+
+    std::array<Type, 3> buffers{};
+    int writeIndex = 0, readIndex = 1;
+    std::atomic<int> shared{ 2 };
+};